@@ -5,6 +5,7 @@
 // Copyright notice in Copyright.txt
 // Reference count, copy-on-write
 #include "../require.h"
+#include "../C13/ObjectPool.h"
 #include <string>
 #include <iostream>
 using namespace std;
@@ -19,6 +20,7 @@ class Dog {
   // Prevent assignment:
   Dog& operator=(const Dog& rv);
 public:
+  OBJECT_POOL(Dog) // new and delete use a pool
   // Dogs can only be created on the heap:
   static Dog* make(const string& name) {
     return new Dog(name);
@@ -0,0 +1,176 @@
+//: C13:AlignedNew.h
+// Over-aligned and huge-page array allocation
+#ifndef ALIGNEDNEW_H
+#define ALIGNEDNEW_H
+#include "../require.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Requests this big or bigger are mapped on
+// 2MB boundaries and marked MADV_HUGEPAGE, so
+// the kernel can back them with huge pages and
+// a scan over them misses the TLB 512 times
+// less often:
+const std::size_t hugePageSize = 2 << 20;
+
+namespace alignedDetail {
+// Just below every block; records how to free
+// it, so delete[] needs no extra arguments:
+struct Header {
+  void* base;         // What malloc/mmap returned
+  std::size_t length; // Of the mapping, or 0
+  std::size_t align;
+  std::size_t count;  // For alignedNewArray
+};
+inline Header* headerOf(void* p) {
+  return (Header*)p - 1;
+}
+inline char* alignUp(char* p, std::size_t a) {
+  return (char*)(((std::uintptr_t)p + a - 1)
+    & ~(std::uintptr_t)(a - 1));
+}
+} // namespace alignedDetail
+
+// align must be a power of two. Returns 0 on
+// failure:
+inline void* alignedAllocateNoThrow(
+  std::size_t sz, std::size_t align) {
+  using namespace alignedDetail;
+  if(align < alignof(Header))
+    align = alignof(Header);
+  std::size_t extra = sizeof(Header) + align;
+  if(sz > ~std::size_t(0) - extra - hugePageSize)
+    return 0;
+  char* base;
+  std::size_t length = 0;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if(sz >= hugePageSize) {
+    // Round up to whole huge pages, over-map by
+    // one, then trim to a 2MB boundary:
+    length = (sz + extra + hugePageSize - 1) &
+      ~(hugePageSize - 1);
+    char* m = (char*)mmap(0, length + hugePageSize,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(m == MAP_FAILED) return 0;
+    base = alignUp(m, hugePageSize);
+    if(base > m) munmap(m, base - m);
+    char* end = m + length + hugePageSize;
+    if(end > base + length)
+      munmap(base + length, end - (base + length));
+    madvise(base, length, MADV_HUGEPAGE);
+  } else
+#endif
+  {
+    base = (char*)std::malloc(sz + extra);
+    if(!base) return 0;
+  }
+  char* p = alignUp(base + sizeof(Header), align);
+  Header* h = headerOf(p);
+  h->base = base;
+  h->length = length;
+  h->align = align;
+  h->count = 0;
+  return p;
+}
+
+// Like operator new: the new_handler gets a
+// chance, then bad_alloc:
+inline void* alignedAllocate(std::size_t sz,
+  std::size_t align) {
+  for(;;) {
+    if(void* p = alignedAllocateNoThrow(sz, align))
+      return p;
+    std::new_handler nh = std::get_new_handler();
+    if(!nh) throw std::bad_alloc();
+    nh();
+  }
+}
+
+inline void alignedFree(void* p) {
+  using namespace alignedDetail;
+  if(!p) return;
+  Header* h = headerOf(p);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if(h->length) {
+    munmap(h->base, h->length);
+    return;
+  }
+#endif
+  std::free(h->base);
+}
+
+// The alignment a block was allocated with:
+inline std::size_t alignmentOf(void* p) {
+  return alignedDetail::headerOf(p)->align;
+}
+
+// n value-initialized Ts at the given alignment
+// (at least alignof(T)); the count is kept in
+// the header for alignedDeleteArray():
+template<class T>
+T* alignedNewArray(std::size_t n,
+  std::size_t align = 64) {
+  if(align < alignof(T)) align = alignof(T);
+  require(n <= ~std::size_t(0) / sizeof(T),
+    "alignedNewArray: size overflows");
+  T* p = (T*)alignedAllocate(n * sizeof(T), align);
+  std::size_t i = 0;
+  try {
+    for(; i < n; i++) new(p + i) T();
+  } catch(...) {
+    while(i > 0) p[--i].~T();
+    alignedFree(p);
+    throw;
+  }
+  alignedDetail::headerOf(p)->count = n;
+  return p;
+}
+
+template<class T>
+void alignedDeleteArray(T* p) {
+  if(!p) return;
+  std::size_t n = alignedDetail::headerOf(p)->count;
+  while(n > 0) p[--n].~T();
+  alignedFree(p);
+}
+
+// Class-level adapter: derive from it and the
+// block for new T[n] is Align-aligned, with
+// big arrays on huge pages. If T has a
+// destructor, the compiler puts a count in
+// front of the elements, shifting them off the
+// boundary; declare T alignas(Align) and the
+// count is padded to keep them aligned. The
+// compiler then calls the align_val_t forms:
+template<std::size_t Align = 64>
+class AlignedArrays {
+  static_assert((Align & (Align - 1)) == 0,
+    "Align must be a power of two");
+public:
+  static void* operator new[](std::size_t sz) {
+    return alignedAllocate(sz, Align);
+  }
+  static void* operator new[](std::size_t sz,
+    std::align_val_t al) {
+    return alignedAllocate(sz,
+      std::size_t(al) > Align ?
+        std::size_t(al) : Align);
+  }
+  static void operator delete[](void* p) {
+    alignedFree(p);
+  }
+  static void operator delete[](void* p,
+    std::align_val_t al) {
+    REQUIRE_AT(REQUIRE_CHEAP, !p ||
+      alignmentOf(p) >= std::size_t(al),
+      "delete[] of a less-aligned block");
+    alignedFree(p);
+  }
+};
+#endif // ALIGNEDNEW_H ///:~
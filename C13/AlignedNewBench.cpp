@@ -0,0 +1,73 @@
+//: C13:AlignedNewBench.cpp
+// Streaming over aligned vs. unaligned arrays
+#include "AlignedNew.h"
+#include "../bench.h"
+#include <cstdio>
+#include <cstdlib>
+using namespace std;
+
+// a = b + s * c, the STREAM "triad":
+__attribute__((noinline))
+void triad(float* a, const float* b,
+  const float* c, float s, size_t n) {
+  for(size_t i = 0; i < n; i++)
+    a[i] = b[i] + s * c[i];
+}
+
+// offset bytes past a 64-byte boundary, so
+// every other vector load splits a line:
+double stream(size_t n, size_t offset, int reps) {
+  char* raw[3];
+  float* v[3];
+  for(int k = 0; k < 3; k++) {
+    raw[k] = (char*)alignedAllocate(
+      n * sizeof(float) + 64, 64);
+    v[k] = (float*)(raw[k] + offset);
+    for(size_t i = 0; i < n; i++) v[k][i] = 1;
+  }
+  Timer t;
+  for(int r = 0; r < reps; r++)
+    triad(v[0], v[1], v[2], 0.5f, n);
+  double secs = t.seconds();
+  keep(v[0][n / 2]);
+  for(int k = 0; k < 3; k++) alignedFree(raw[k]);
+  return secs;
+}
+
+// Random reads over a large array: page size
+// decides how often the TLB misses:
+double gather(float* a, size_t n, long reads) {
+  unsigned long r = 88172645463325252UL;
+  float sum = 0;
+  Timer t;
+  for(long i = 0; i < reads; i++) {
+    r ^= r << 13; r ^= r >> 7; r ^= r << 17;
+    sum += a[r % n];
+  }
+  keep(sum);
+  return t.seconds();
+}
+
+int main(int argc, char* argv[]) {
+  int reps = benchArg(argc, argv, 1, 20000);
+  size_t small = 4096; // Three arrays in L1/L2
+  long elems = long(small) * reps;
+  report("triad, 64-byte aligned",
+    stream(small, 0, reps), elems);
+  report("triad, offset 4 bytes",
+    stream(small, 4, reps), elems);
+  report("triad, offset 32 bytes",
+    stream(small, 32, reps), elems);
+  size_t n = (512UL << 20) / sizeof(float);
+  long reads = 20000000;
+  float* huge = alignedNewArray<float>(n, 64);
+  report("gather 512MB, huge pages",
+    gather(huge, n, reads), reads);
+  alignedDeleteArray(huge);
+  // malloc'd and touched: 4K pages
+  float* plain = (float*)calloc(n, sizeof(float));
+  for(size_t i = 0; i < n; i += 1024) plain[i] = 0;
+  report("gather 512MB, malloc",
+    gather(plain, n, reads), reads);
+  free(plain);
+} ///:~
@@ -0,0 +1,67 @@
+//: C13:AlignedNewTest.cpp
+// Alignment, huge pages, and matching delete[]
+#include "AlignedNew.h"
+#include "../require.h"
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+using namespace std;
+
+int constructed = 0, destroyed = 0;
+
+// Trivially destructible: no array cookie, so
+// the elements start on the block boundary:
+class Sample : public AlignedArrays<64> {
+public:
+  float v[3];
+};
+
+// Has a destructor, so alignas() keeps the
+// elements aligned past the cookie:
+class alignas(64) Widget 
+  : public AlignedArrays<64> {
+  float v[16];
+public:
+  Widget() { constructed++; v[0] = 1; }
+  ~Widget() { destroyed++; }
+};
+
+bool aligned(const void* p, size_t a) {
+  return (uintptr_t)p % a == 0;
+}
+
+int main() {
+  for(size_t a = 8; a <= 4096; a *= 2)
+    for(size_t sz = 1; sz < 100000; sz *= 7) {
+      char* p = (char*)alignedAllocate(sz, a);
+      require(aligned(p, a), "Misaligned");
+      require(alignmentOf(p) == a);
+      memset(p, 0xAB, sz);
+      alignedFree(p);
+    }
+  // Big blocks come from huge-page mappings:
+  size_t big = 3 * hugePageSize + 5;
+  char* h = (char*)alignedAllocate(big, 64);
+  require(aligned(h, 64));
+  memset(h, 1, big);
+  alignedFree(h);
+  Sample* s = new Sample[1000];
+  require(aligned(s, 64), "Sample[] misaligned");
+  delete []s;
+  Widget* w = new Widget[100];
+  require(aligned(w, 64), "Widget[] misaligned");
+  require(aligned(&w[1], 64));
+  require(constructed == 100);
+  delete []w;
+  require(destroyed == 100);
+  // Typed helpers keep the count themselves:
+  constructed = destroyed = 0;
+  double* d = alignedNewArray<double>(1 << 20, 256);
+  require(aligned(d, 256) && d[12345] == 0.0);
+  alignedDeleteArray(d);
+  Widget* w2 = alignedNewArray<Widget>(10, 128);
+  require(aligned(w2, 128) && constructed == 10);
+  alignedDeleteArray(w2);
+  require(destroyed == 10);
+  cout << "AlignedNew OK" << endl;
+} ///:~
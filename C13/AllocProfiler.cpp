@@ -0,0 +1,346 @@
+//: C13:AllocProfiler.cpp {O}
+// Sampling allocation profiler behind operator new
+// Link this into a program, as with
+// GlobalOperatorNew.cpp, but instead of printing
+// each call it keeps, for every allocation, a
+// size histogram and live-byte count, and for a
+// sample of them, chosen about once per
+// ALLOCPROF_RATE bytes (default 512K), a
+// backtrace identifying the call site. The
+// report goes to stderr, or to the file named
+// by ALLOCPROF_OUT, at exit and whenever the
+// process gets SIGUSR2. Can't be combined with
+// another global operator new (SizeClassNew).
+// Needs glibc's backtrace().
+#include "AllocProfiler.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <csignal>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <mutex>
+#include <new>
+#include <unistd.h>
+using namespace std;
+
+namespace {
+// Precedes every block, keeping the
+// max_align_t alignment malloc gives:
+struct alignas(alignof(max_align_t)) Header {
+  size_t size;
+  int32_t site;     // -1 if not sampled
+  uint32_t weight;  // Sampled bytes it stands for
+};
+
+// sample(), allocate() and operator new:
+const int maxDepth = 12, skipFrames = 3;
+const int siteCapacity = 4096; // Power of two
+const int histBuckets = 40;    // log2 of size
+
+struct Site {
+  atomic<uint64_t> key;  // 0 = empty slot
+  atomic<bool> ready;    // frames are written
+  void* frames[maxDepth];
+  int depth;
+  atomic<unsigned long> samples;
+  atomic<unsigned long long> bytes; // Estimated
+  atomic<long long> live;           // Estimated
+};
+Site sites[siteCapacity];
+atomic<unsigned> siteCount(0);
+atomic<unsigned long> droppedSamples(0);
+
+atomic<unsigned long> allocs(0), frees(0), 
+  samples(0);
+atomic<unsigned long long> totalBytes(0),
+  sampledBytes(0); // Sum of sample weights
+atomic<long long> liveBytes(0);
+atomic<unsigned long> histCount[histBuckets];
+atomic<unsigned long long> histBytes[histBuckets];
+
+volatile sig_atomic_t dumpRequested = 0;
+// One dump at a time: a SIGUSR2 dump from one
+// thread's operator new can meet an explicit
+// or at-exit dump on another:
+mutex dumpLock;
+atomic<long> sampleRate(-1); // Read lazily
+thread_local long untilSample = 0;
+thread_local bool started = false;
+thread_local uint64_t rng = 0;
+thread_local bool busy = false; // No recursion
+
+int bucketOf(size_t sz) {
+  int b = sz ? 64 - __builtin_clzll(sz) : 0;
+  return b < histBuckets ? b : histBuckets - 1;
+}
+
+long rate() {
+  long r = sampleRate.load(memory_order_relaxed);
+  if(r < 0) {
+    const char* e = getenv("ALLOCPROF_RATE");
+    r = e ? atol(e) : 512 * 1024;
+    if(r < 1) r = 1;
+    sampleRate = r;
+  }
+  return r;
+}
+
+// Bytes to the next sample: exponentially
+// distributed with mean rate(), so samples
+// don't lock onto a periodic pattern:
+long nextGap() {
+  if(!rng) rng = (uintptr_t)&rng | 1;
+  rng ^= rng << 13; rng ^= rng >> 7; 
+  rng ^= rng << 17;
+  double u = (rng >> 11) * (1.0 / 9007199254740992.0);
+  return long(-log(1 - u) * rate()) + 1;
+}
+
+uint64_t hashFrames(void** f, int n) {
+  uint64_t h = 1469598103934665603ULL;
+  for(int i = 0; i < n; i++) {
+    h ^= (uintptr_t)f[i];
+    h *= 1099511628211ULL;
+  }
+  return h ? h : 1;
+}
+
+// Find or claim the Site for this backtrace
+// in the open-addressed table:
+int findSite(void** f, int n) {
+  uint64_t h = hashFrames(f, n);
+  for(int probe = 0; probe < siteCapacity; 
+      probe++) {
+    int i = (h + probe) & (siteCapacity - 1);
+    uint64_t k = sites[i].key.load(
+      memory_order_acquire);
+    if(k == h) return i;
+    if(k == 0) {
+      uint64_t empty = 0;
+      if(sites[i].key.compare_exchange_strong(
+        empty, h)) {
+        memcpy(sites[i].frames, f, 
+          n * sizeof(void*));
+        sites[i].depth = n;
+        sites[i].ready.store(true, 
+          memory_order_release);
+        siteCount++;
+        return i;
+      }
+      if(empty == h) return i;
+    }
+  }
+  return -1; // Table full
+}
+
+// Not inlined, so skipFrames is exact:
+__attribute__((noinline)) 
+void sample(Header* h) {
+  void* frames[maxDepth + skipFrames];
+  int n = backtrace(frames, maxDepth + skipFrames);
+  int skip = n > skipFrames ? skipFrames : 0;
+  int site = findSite(frames + skip, n - skip);
+  if(site < 0) {
+    droppedSamples++;
+    return;
+  }
+  // The bytes this sample stands for, so that
+  // totals are unbiased: small blocks are
+  // sampled with probability size / rate. The
+  // countdown charges size + 1, so that a
+  // zero-size block (which can be sampled)
+  // gets a finite weight; so does this:
+  double r = double(rate()),
+    s = double(h->size) + 1;
+  double w = s / (1 - exp(-s / r));
+  h->site = site;
+  h->weight = w > 4e9 ? 4000000000u : uint32_t(w);
+  Site& st = sites[site];
+  st.samples++;
+  st.bytes += h->weight;
+  st.live += h->weight;
+  sampledBytes += h->weight;
+  samples++;
+}
+
+__attribute__((noinline)) 
+void* allocate(size_t sz) {
+  if(dumpRequested && !busy) {
+    dumpRequested = 0;
+    busy = true;
+    allocProfilerDump(-1);
+    busy = false;
+  }
+  for(;;) {
+    if(sz <= ~size_t(0) - sizeof(Header)) {
+      if(Header* h = (Header*)malloc(
+        sizeof(Header) + sz)) {
+        h->size = sz;
+        h->site = -1;
+        h->weight = 0;
+        allocs.fetch_add(1, memory_order_relaxed);
+        totalBytes.fetch_add(sz, 
+          memory_order_relaxed);
+        liveBytes.fetch_add(sz, 
+          memory_order_relaxed);
+        int b = bucketOf(sz);
+        histCount[b].fetch_add(1, 
+          memory_order_relaxed);
+        histBytes[b].fetch_add(sz, 
+          memory_order_relaxed);
+        if((untilSample -= long(sz) + 1) < 0 &&
+           !busy) {
+          busy = true;
+          // A thread's first allocation only
+          // starts its countdown:
+          if(started) sample(h);
+          started = true;
+          untilSample = nextGap();
+          busy = false;
+        }
+        return h + 1;
+      }
+    }
+    new_handler nh = get_new_handler();
+    if(!nh) throw bad_alloc();
+    nh();
+  }
+}
+
+void deallocate(void* p) {
+  if(!p) return;
+  Header* h = (Header*)p - 1;
+  frees.fetch_add(1, memory_order_relaxed);
+  liveBytes.fetch_sub(h->size, 
+    memory_order_relaxed);
+  if(h->site >= 0)
+    sites[h->site].live -= h->weight;
+  free(h);
+}
+
+void onSignal(int) { dumpRequested = 1; }
+
+// Installs the signal handler before main()
+// and writes the report at exit:
+struct Reporter {
+  Reporter() { signal(SIGUSR2, onSignal); }
+  ~Reporter() { allocProfilerDump(-1); }
+} reporter;
+
+// Format without allocating:
+void put(int fd, const char* fmt, ...) 
+  __attribute__((format(printf, 2, 3)));
+void put(int fd, const char* fmt, ...) {
+  char buf[256];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof buf, fmt, ap);
+  va_end(ap);
+  if(n > 0) {
+    ssize_t r = write(fd, buf, 
+      n < int(sizeof buf) ? n : sizeof buf - 1);
+    (void)r;
+  }
+}
+} // namespace
+
+AllocProfile allocProfile() {
+  AllocProfile p;
+  p.allocs = allocs;
+  p.frees = frees;
+  p.bytes = totalBytes;
+  p.liveBytes = liveBytes;
+  p.samples = samples;
+  p.estimatedBytes = sampledBytes;
+  p.sites = siteCount;
+  return p;
+}
+
+void allocProfilerDump(int fd) {
+  lock_guard<mutex> g(dumpLock);
+  // -1: the environment decides
+  bool opened = false;
+  if(fd < 0) {
+    const char* out = getenv("ALLOCPROF_OUT");
+    fd = out ? open(out, O_WRONLY | O_CREAT |
+      O_APPEND, 0644) : 2;
+    if(fd < 0) fd = 2;
+    else opened = out != 0;
+  }
+  AllocProfile p = allocProfile();
+  put(fd, "Allocation profile: %lu allocs, %lu "
+    "frees, %llu bytes, %lld live\n", p.allocs,
+    p.frees, p.bytes, p.liveBytes);
+  put(fd, "%12s %12s %14s\n", "size <=", 
+    "count", "bytes");
+  for(int b = 0; b < histBuckets; b++)
+    if(unsigned long c = histCount[b])
+      put(fd, "%12llu %12lu %14llu\n", 
+        b ? 1ULL << b : 0ULL, c, 
+        (unsigned long long)histBytes[b]);
+  // Top sites by estimated bytes allocated:
+  static int order[siteCapacity];
+  int n = 0;
+  for(int i = 0; i < siteCapacity; i++)
+    if(sites[i].ready.load(memory_order_acquire))
+      order[n++] = i;
+  sort(order, order + n, [](int a, int b) {
+    return sites[a].bytes > sites[b].bytes; });
+  put(fd, "%lu samples at %u call sites "
+    "(%lu dropped), 1 per %ld bytes\n", 
+    p.samples, p.sites, 
+    (unsigned long)droppedSamples, rate());
+  for(int k = 0; k < n && k < 10; k++) {
+    Site& s = sites[order[k]];
+    put(fd, "#%d: ~%llu bytes allocated, ~%lld "
+      "live, %lu samples\n", k + 1, 
+      (unsigned long long)s.bytes, 
+      (long long)s.live, (unsigned long)s.samples);
+    backtrace_symbols_fd(s.frames, s.depth, fd);
+  }
+  if(opened) close(fd);
+}
+
+void* operator new(size_t sz) {
+  return allocate(sz);
+}
+void* operator new[](size_t sz) {
+  return allocate(sz);
+}
+void* operator new(size_t sz,
+  const nothrow_t&) noexcept {
+  try { return allocate(sz); }
+  catch(...) { return 0; }
+}
+void* operator new[](size_t sz,
+  const nothrow_t&) noexcept {
+  try { return allocate(sz); }
+  catch(...) { return 0; }
+}
+void operator delete(void* p) noexcept {
+  deallocate(p);
+}
+void operator delete[](void* p) noexcept {
+  deallocate(p);
+}
+void operator delete(void* p, size_t) noexcept {
+  deallocate(p);
+}
+void operator delete[](void* p,
+  size_t) noexcept {
+  deallocate(p);
+}
+void operator delete(void* p,
+  const nothrow_t&) noexcept {
+  deallocate(p);
+}
+void operator delete[](void* p,
+  const nothrow_t&) noexcept {
+  deallocate(p);
+} ///:~
@@ -0,0 +1,20 @@
+//: C13:AllocProfiler.h
+// Reports from the sampling allocation profiler
+#ifndef ALLOCPROFILER_H
+#define ALLOCPROFILER_H
+#include <cstddef>
+
+struct AllocProfile {
+  unsigned long allocs, frees;
+  unsigned long long bytes; // Ever allocated
+  long long liveBytes;      // Exact
+  unsigned long samples;
+  // bytes, estimated from the samples alone:
+  unsigned long long estimatedBytes;
+  unsigned sites;           // Distinct call sites
+};
+AllocProfile allocProfile();
+// Write the histogram and the top call sites
+// to a file descriptor. Doesn't allocate:
+void allocProfilerDump(int fd = 2);
+#endif // ALLOCPROFILER_H ///:~
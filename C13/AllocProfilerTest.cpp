@@ -0,0 +1,59 @@
+//: C13:AllocProfilerTest.cpp
+//{L} AllocProfiler
+// Totals are exact; sampled estimates are close
+// Link with -rdynamic to see function names
+// in the call-site report.
+#include "AllocProfiler.h"
+#include "../require.h"
+#include <cmath>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Two call sites with different volumes:
+vector<unique_ptr<char[]>> kept;
+void keepMany() {
+  for(int i = 0; i < 32 * 1024; i++)
+    kept.emplace_back(new char[1024]);
+}
+long churnList() {
+  long sum = 0;
+  for(int r = 0; r < 100; r++) {
+    list<int> l;
+    for(int i = 0; i < 1000; i++) l.push_back(i);
+    sum += l.size();
+  }
+  return sum;
+}
+
+int main() {
+  AllocProfile a = allocProfile();
+  keepMany();
+  AllocProfile b = allocProfile();
+  long kb = 32 * 1024 * 1024L;
+  require(b.liveBytes - a.liveBytes >= kb,
+    "Live bytes too low");
+  require(b.allocs - a.allocs >= 32 * 1024);
+  // 32MB at one sample per 512K on average:
+  unsigned long s = b.samples - a.samples;
+  require(s > 20 && s < 200, 
+    "Sample count far from expected");
+  // The weighted samples estimate the bytes
+  // allocated. About 64 samples give a
+  // standard error near 1/8, so allow 4 of
+  // them either way:
+  double est = double(b.estimatedBytes -
+    a.estimatedBytes);
+  require(fabs(est - kb) < 0.5 * kb,
+    "Estimate far from the true total");
+  require(churnList() == 100000);
+  AllocProfile c = allocProfile();
+  require(c.allocs - b.allocs >= 100000);
+  require(c.sites >= 2, "Expected two sites");
+  kept.clear();
+  AllocProfile d = allocProfile();
+  require(c.liveBytes - d.liveBytes >= kb);
+  allocProfilerDump(1);
+} ///:~
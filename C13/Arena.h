@@ -0,0 +1,184 @@
+//: C13:Arena.h
+// Monotonic arena: bump allocation, bulk free
+#ifndef ARENA_H
+#define ARENA_H
+#include "../require.h"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#if defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define ARENA_PMR 1
+#endif
+#endif
+
+class Arena {
+  // Blocks are chained newest first; the
+  // storage follows each header directly:
+  struct Block {
+    Block* prev;
+    std::size_t size;
+  }* current;
+  Block* first; // Oldest Block in use
+  Block* spare; // Kept by reset() and rewind()
+  char* ptr;   // Next free byte
+  char* limit; // End of the current Block
+  std::size_t blockSize;
+  static char* alignUp(char* p, std::size_t a) {
+    return (char*)(((std::size_t)p + a - 1)
+      & ~(a - 1));
+  }
+  void grow(std::size_t sz, std::size_t align) {
+    // Else need, or the malloc size, wraps:
+    if(sz > ~std::size_t(0) - align -
+       sizeof(Block))
+      throw std::bad_alloc();
+    std::size_t need = sz + align;
+    Block* b = spare;
+    if(b && b->size >= need)
+      spare = b->prev; // Reuse, no malloc
+    else {
+      std::size_t bsz =
+        need > blockSize ? need : blockSize;
+      b = (Block*)std::malloc(sizeof(Block) + bsz);
+      if(!b) throw std::bad_alloc();
+      b->size = bsz;
+    }
+    b->prev = current;
+    if(!current) first = b;
+    current = b;
+    ptr = (char*)(b + 1);
+    limit = ptr + b->size;
+  }
+  static void freeChain(Block* b) {
+    while(b) {
+      Block* prev = b->prev;
+      std::free(b);
+      b = prev;
+    }
+  }
+  Arena(const Arena&);
+  void operator=(const Arena&);
+public:
+  Arena(std::size_t blockSz = 64 * 1024)
+    : current(0), first(0), spare(0), ptr(0),
+      limit(0), blockSize(blockSz) {}
+  ~Arena() { release(); }
+  // align must be a power of two:
+  void* allocate(std::size_t sz,
+    std::size_t align = alignof(std::max_align_t)) {
+    char* p = alignUp(ptr, align);
+    // Compare sizes: p + sz could overflow
+    if(!ptr || p > limit ||
+       sz > std::size_t(limit - p)) {
+      grow(sz, align);
+      p = alignUp(ptr, align);
+    }
+    ptr = p + sz;
+    return p;
+  }
+  // Placement new into the Arena. Destructors
+  // are never run by the Arena; call them
+  // yourself if T needs it:
+  template<class T, class... Args>
+  T* create(Args&&... args) {
+    return new(allocate(sizeof(T), alignof(T)))
+      T(std::forward<Args>(args)...);
+  }
+  // n default-constructed Ts, contiguous:
+  template<class T>
+  T* createArray(std::size_t n) {
+    require(n <= ~std::size_t(0) / sizeof(T),
+      "Arena::createArray: size overflows");
+    T* p = (T*)allocate(sizeof(T) * n, alignof(T));
+    for(std::size_t i = 0; i < n; i++)
+      new(p + i) T();
+    return p;
+  }
+  // A checkpoint to rewind() to:
+  class Marker {
+    friend class Arena;
+    Block* block;
+    char* ptr;
+    char* limit;
+  };
+  Marker mark() const {
+    Marker m;
+    m.block = current;
+    m.ptr = ptr;
+    m.limit = limit;
+    return m;
+  }
+  // Forget everything allocated since m was
+  // taken. Blocks added since are kept for
+  // reuse:
+  void rewind(const Marker& m) {
+    while(current != m.block) {
+      require(current != 0,
+        "Arena::rewind() to a foreign Marker");
+      Block* prev = current->prev;
+      current->prev = spare;
+      spare = current;
+      current = prev;
+    }
+    if(!current) first = 0;
+    ptr = m.ptr;
+    limit = m.limit;
+  }
+  // Rewinds to its construction point when it
+  // goes out of scope:
+  class Scope {
+    Arena& arena;
+    Marker m;
+    Scope(const Scope&);
+    void operator=(const Scope&);
+  public:
+    explicit Scope(Arena& a)
+      : arena(a), m(a.mark()) {}
+    ~Scope() { arena.rewind(m); }
+  };
+  // Forget everything, in O(1). The Blocks
+  // are kept for reuse, not freed:
+  void reset() {
+    if(current) {
+      first->prev = spare;
+      spare = current;
+      current = first = 0;
+    }
+    ptr = limit = 0;
+  }
+  // Free every Block at once. Destructors of
+  // objects placed in the Arena are not run:
+  void release() {
+    freeChain(current);
+    freeChain(spare);
+    current = first = spare = 0;
+    ptr = limit = 0;
+  }
+};
+
+#ifdef ARENA_PMR
+// Lets pmr containers allocate from an Arena.
+// deallocate() does nothing; the memory comes
+// back on the Arena's reset() or release():
+class ArenaResource
+  : public std::pmr::memory_resource {
+  Arena& arena;
+  void* do_allocate(std::size_t bytes,
+    std::size_t align) override {
+    return arena.allocate(bytes, align);
+  }
+  void do_deallocate(void*, std::size_t,
+    std::size_t) override {}
+  bool do_is_equal(const
+    std::pmr::memory_resource& other) const
+    noexcept override {
+    return this == &other;
+  }
+public:
+  explicit ArenaResource(Arena& a) : arena(a) {}
+};
+#endif
+#endif // ARENA_H ///:~
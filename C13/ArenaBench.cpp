@@ -0,0 +1,102 @@
+//: C13:ArenaBench.cpp
+// Per-request objects: new/delete vs. Arena
+#include "Arena.h"
+#include "../bench.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#ifdef ARENA_PMR
+#include <memory_resource>
+#endif
+using namespace std;
+
+struct Node {
+  Node* next;
+  int key;
+  double value;
+  Node(Node* n, int k) : next(n), key(k), 
+    value(k * 0.5) {}
+};
+
+// A "request" builds a list of Nodes, sums
+// it and throws it all away:
+double heapRequests(long requests, int nodes) {
+  Timer t;
+  double sum = 0;
+  for(long r = 0; r < requests; r++) {
+    Node* head = 0;
+    for(int i = 0; i < nodes; i++)
+      head = new Node(head, i);
+    for(Node* n = head; n; n = n->next)
+      sum += n->value;
+    while(head) {
+      Node* next = head->next;
+      delete head;
+      head = next;
+    }
+  }
+  keep(sum);
+  return t.seconds();
+}
+
+double arenaRequests(long requests, int nodes) {
+  Arena a;
+  Timer t;
+  double sum = 0;
+  for(long r = 0; r < requests; r++) {
+    Node* head = 0;
+    for(int i = 0; i < nodes; i++)
+      head = a.create<Node>(head, i);
+    for(Node* n = head; n; n = n->next)
+      sum += n->value;
+    a.reset(); // All of it, in O(1)
+  }
+  keep(sum);
+  return t.seconds();
+}
+
+#ifdef ARENA_PMR
+// Library containers, through the adapter:
+template<class Vec>
+double vectors(long requests, int n, Vec make) {
+  Timer t;
+  long total = 0;
+  for(long r = 0; r < requests; r++)
+    total += make(n);
+  keep(total);
+  return t.seconds();
+}
+#endif
+
+int main(int argc, char* argv[]) {
+  long requests = benchArg(argc, argv, 1, 20000);
+  int nodes = benchArg(argc, argv, 2, 200);
+  long ops = requests * nodes;
+  report("new/delete per Node",
+    heapRequests(requests, nodes), ops);
+  report("Arena create, reset per request",
+    arenaRequests(requests, nodes), ops);
+#ifdef ARENA_PMR
+  report("vector<string>", vectors(requests, 
+    nodes, [](int n) {
+      vector<string> v;
+      for(int i = 0; i < n; i++)
+        v.emplace_back(32, 'x');
+      return long(v.size());
+    }), ops);
+  Arena a;
+  report("pmr::vector<pmr::string> in Arena",
+    vectors(requests, nodes, [&a](int n) {
+      long size;
+      {
+        ArenaResource res(a);
+        pmr::vector<pmr::string> v(&res);
+        for(int i = 0; i < n; i++)
+          v.emplace_back(32, 'x');
+        size = long(v.size());
+      }
+      a.reset();
+      return size;
+    }), ops);
+#endif
+} ///:~
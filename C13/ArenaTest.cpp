@@ -0,0 +1,85 @@
+//: C13:ArenaTest.cpp
+// Alignment, markers, reset and pmr containers
+#include "Arena.h"
+#include "../require.h"
+#include <cstdint>
+#include <new>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+struct alignas(64) Line { char c[64]; };
+
+struct Point {
+  int x, y;
+  Point(int a = 0, int b = 0) : x(a), y(b) {}
+};
+
+int main() {
+  Arena a(1024);
+  // Alignment is honored for each request:
+  for(size_t al = 1; al <= 256; al *= 2) {
+    a.allocate(1, 1);
+    void* p = a.allocate(3, al);
+    require((uintptr_t)p % al == 0, "Misaligned");
+  }
+  Line* l = a.create<Line>();
+  require((uintptr_t)l % 64 == 0);
+  Point* pt = a.create<Point>(3, 4);
+  require(pt->x == 3 && pt->y == 4);
+  Point* pts = a.createArray<Point>(100);
+  require(pts[99].x == 0);
+  // Bigger than a Block gets its own:
+  char* big = (char*)a.allocate(10000);
+  big[9999] = 1;
+  // Sizes near SIZE_MAX throw instead of
+  // wrapping to a small block:
+  for(std::size_t off = 0; off < 100; off += 33) {
+    volatile std::size_t huge =
+      ~std::size_t(0) - off;
+    bool threw = false;
+    try {
+      a.createArray<char>(huge);
+    } catch(std::bad_alloc&) {
+      threw = true;
+    }
+    require(threw, "Huge request didn't throw");
+  }
+  // A Scope rewinds on exit, so the next
+  // allocation reuses the same storage:
+  void* before;
+  {
+    Arena::Scope s(a);
+    before = a.allocate(16);
+    for(int i = 0; i < 1000; i++)
+      a.allocate(100); // Spans new Blocks
+  }
+  require(a.allocate(16) == before,
+    "Scope didn't rewind");
+  // reset() keeps the Blocks; after it, the
+  // same sequence lands in the same places:
+  a.reset();
+  Arena::Marker m = a.mark();
+  Point* again = a.create<Point>(1, 2);
+  a.rewind(m);
+  require(a.create<Point>(5, 6) == again);
+  a.reset();
+#ifdef ARENA_PMR
+  {
+    ArenaResource res(a);
+    std::pmr::vector<std::pmr::string> v(&res);
+    for(int i = 0; i < 1000; i++)
+      v.emplace_back(string(40, 'a' + i % 26));
+    require(v.size() == 1000 && v[27][0] == 'b');
+    std::pmr::unordered_map<int, int> sq(&res);
+    for(int i = 0; i < 1000; i++) sq[i] = i * i;
+    require(sq[31] == 961);
+  }
+#endif
+  a.reset();
+  a.release();
+  require(a.allocate(8) != 0);
+  cout << "Arena OK" << endl;
+} ///:~
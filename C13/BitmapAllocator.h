@@ -0,0 +1,205 @@
+//: C13:BitmapAllocator.h
+// Occupancy bitmap searched a word at a time
+#ifndef BITMAPALLOCATOR_H
+#define BITMAPALLOCATOR_H
+#include "../require.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace bits {
+// Index of the lowest set bit; w must not be 0:
+inline int ctz(std::uint64_t w) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(w);
+#else
+  int n = 0;
+  while(!(w & 1)) { w >>= 1; n++; }
+  return n;
+#endif
+}
+inline int popcount(std::uint64_t w) {
+#if defined(__GNUC__)
+  return __builtin_popcountll(w);
+#else
+  int n = 0;
+  for(; w; w &= w - 1) n++;
+  return n;
+#endif
+}
+} // namespace bits
+
+// One bit per block, set when the block is in
+// use: 64 blocks per word searched, and an
+// eighth of the space of a bool per block.
+// Bits past size() are kept set, so searches
+// never need to check for the end of the map:
+class Bitmap {
+  std::vector<std::uint64_t> words;
+  std::size_t nbits;
+  enum { wordBits = 64 };
+  // Set (or clear) bits [first, first + n):
+  template<bool Set>
+  void assign(std::size_t first, std::size_t n) {
+    while(n) {
+      std::size_t i = first / wordBits;
+      std::size_t b = first % wordBits;
+      std::size_t k = wordBits - b < n ?
+        wordBits - b : n;
+      std::uint64_t mask = (k == wordBits ?
+        ~std::uint64_t(0) :
+        ((std::uint64_t(1) << k) - 1)) << b;
+      if(Set) words[i] |= mask;
+      else words[i] &= ~mask;
+      first += k;
+      n -= k;
+    }
+  }
+  // First bit >= from whose value is Used,
+  // or size() if there is none:
+  template<bool Used>
+  std::size_t scan(std::size_t from) const {
+    if(from >= nbits) return nbits;
+    std::size_t i = from / wordBits;
+    std::uint64_t w = (Used ? words[i] :
+      ~words[i]) & (~std::uint64_t(0) <<
+      (from % wordBits));
+    while(!w) {
+      if(++i == words.size()) return nbits;
+      w = Used ? words[i] : ~words[i];
+    }
+    std::size_t r = i * wordBits + bits::ctz(w);
+    return r < nbits ? r : nbits;
+  }
+  // First run of n free bits starting in
+  // [from, stop):
+  std::size_t run(std::size_t n,
+    std::size_t from, std::size_t stop) const {
+    while(from < stop) {
+      std::size_t p = scan<false>(from);
+      if(p >= stop) break;
+      std::size_t end = scan<true>(p);
+      if(end - p >= n) return p;
+      from = end; // Skip the whole used stretch
+    }
+    return npos;
+  }
+public:
+  static const std::size_t npos = ~std::size_t(0);
+  explicit Bitmap(std::size_t n)
+    : words((n + wordBits - 1) / wordBits),
+      nbits(n) {
+    if(n % wordBits)
+      words.back() = ~std::uint64_t(0) <<
+        (n % wordBits);
+  }
+  std::size_t size() const { return nbits; }
+  bool test(std::size_t i) const {
+    return words[i / wordBits] >>
+      (i % wordBits) & 1;
+  }
+  void set(std::size_t first, std::size_t n = 1) {
+    assign<true>(first, n);
+  }
+  void clear(std::size_t first, std::size_t n = 1) {
+    assign<false>(first, n);
+  }
+  // True if every bit in the range is clear:
+  bool isFree(std::size_t first,
+    std::size_t n) const {
+    return first + n <= nbits &&
+      scan<true>(first) >= first + n;
+  }
+  // Bits in use, padding excluded:
+  std::size_t count() const {
+    std::size_t n = 0;
+    for(std::uint64_t w : words)
+      n += bits::popcount(w);
+    return n - (words.size() * wordBits - nbits);
+  }
+  // First free bit at or after hint, wrapping
+  // around to the start; npos when full:
+  std::size_t findFree(std::size_t hint = 0) const {
+    if(hint >= nbits) hint = 0;
+    std::size_t p = scan<false>(hint);
+    if(p == nbits) p = scan<false>(0);
+    return p < nbits ? p : npos;
+  }
+  // First bit in use at or after from, or
+  // size() if none; walks the used bits in
+  // order a word at a time:
+  std::size_t findUsed(std::size_t from) const {
+    return scan<true>(from);
+  }
+  // First run of n free bits at or after hint,
+  // then from the start; npos if none fits:
+  std::size_t findFreeRun(std::size_t n,
+    std::size_t hint = 0) const {
+    if(n == 0 || n > nbits) return npos;
+    if(hint >= nbits) hint = 0;
+    std::size_t p = run(n, hint, nbits);
+    if(p == npos && hint > 0)
+      p = run(n, 0, hint);
+    return p;
+  }
+  std::size_t bytes() const {
+    return words.size() * sizeof(std::uint64_t);
+  }
+};
+
+// Blocks of BlockSize bytes tracked by a Bitmap.
+// allocate(n) returns n contiguous blocks; the
+// search starts where the last one ended (next
+// fit), so a run of allocations is a sequence
+// of short scans rather than rescanning the
+// used prefix each time. Not thread-safe:
+template<std::size_t BlockSize = 64>
+class BitmapAllocator {
+  char* base;
+  Bitmap map;
+  std::size_t hint;
+  BitmapAllocator(const BitmapAllocator&);
+  void operator=(const BitmapAllocator&);
+public:
+  enum { blockSize = BlockSize };
+  explicit BitmapAllocator(std::size_t nBlocks)
+    : base((char*)::operator new(
+        nBlocks * BlockSize)),
+      map(nBlocks), hint(0) {}
+  ~BitmapAllocator() { ::operator delete(base); }
+  void* allocate(std::size_t nBlocks = 1) {
+    std::size_t p = nBlocks == 1 ?
+      map.findFree(hint) :
+      map.findFreeRun(nBlocks, hint);
+    if(p == Bitmap::npos)
+      throw std::bad_alloc();
+    map.set(p, nBlocks);
+    hint = p + nBlocks;
+    return base + p * BlockSize;
+  }
+  // nBlocks must match the allocate() call:
+  void deallocate(void* ptr,
+    std::size_t nBlocks = 1) {
+    if(!ptr) return;
+    REQUIRE_AT(REQUIRE_CHEAP, owns(ptr),
+      "BitmapAllocator: pointer not from here");
+    std::size_t i =
+      ((char*)ptr - base) / BlockSize;
+    REQUIRE_AT(REQUIRE_CHEAP, map.test(i),
+      "BitmapAllocator: block already free");
+    map.clear(i, nBlocks);
+  }
+  bool owns(const void* ptr) const {
+    const char* p = (const char*)ptr;
+    return p >= base &&
+      p < base + map.size() * BlockSize &&
+      (p - base) % BlockSize == 0;
+  }
+  std::size_t capacity() const {
+    return map.size();
+  }
+  std::size_t used() const { return map.count(); }
+  const Bitmap& bitmap() const { return map; }
+};
+#endif // BITMAPALLOCATOR_H ///:~
@@ -0,0 +1,83 @@
+//: C13:BitmapBench.cpp
+// Word-at-a-time bitmap vs. Framis's bool map
+#include "BitmapAllocator.h"
+#include "../bench.h"
+#include <cstdio>
+#include <vector>
+using namespace std;
+
+// Framis's search: one bool per block,
+// examined one at a time from the start:
+class BoolMap {
+  vector<char> used;
+public:
+  explicit BoolMap(size_t n) : used(n, 0) {}
+  size_t allocate() {
+    for(size_t i = 0; i < used.size(); i++)
+      if(!used[i]) { used[i] = 1; return i; }
+    return size_t(-1);
+  }
+  void deallocate(size_t i) { used[i] = 0; }
+};
+
+class Bits {
+  Bitmap map;
+public:
+  explicit Bits(size_t n) : map(n) {}
+  size_t allocate() {
+    size_t p = map.findFree();
+    map.set(p);
+    return p;
+  }
+  void deallocate(size_t i) { map.clear(i); }
+};
+
+// Keep the map 90% full and replace random
+// blocks, so every search crosses used space:
+template<class Map>
+double churn(size_t n, long ops) {
+  Map m(n);
+  vector<size_t> live(n * 9 / 10);
+  for(auto& i : live) i = m.allocate();
+  unsigned r = 12345;
+  Timer t;
+  for(long k = 0; k < ops; k++) {
+    r = r * 1103515245 + 12345;
+    size_t& i = live[(r >> 8) % live.size()];
+    m.deallocate(i);
+    i = m.allocate();
+  }
+  keep(live[0]);
+  return t.seconds();
+}
+
+int main(int argc, char* argv[]) {
+  long ops = benchArg(argc, argv, 1, 50000);
+  for(size_t n = 1000; n <= 100000; n *= 10) {
+    printf("%zu blocks:\n", n);
+    report("  bool per block",
+      churn<BoolMap>(n, ops), ops);
+    report("  64-bit words, ctz",
+      churn<Bits>(n, ops), ops);
+  }
+  // Contiguous runs from a fragmented map:
+  // every 64 blocks hold a hole of 7, too
+  // short, and only the last group one of 8:
+  const size_t n = 1 << 16;
+  BitmapAllocator<64> a(n);
+  vector<char*> v(n);
+  for(auto& p : v) p = (char*)a.allocate();
+  for(size_t i = 0; i < n; i += 64)
+    for(size_t j = 0; j < 7; j++)
+      a.deallocate(v[i + j]);
+  a.deallocate(v[n - 64 + 7]);
+  Timer t;
+  long runs = 0;
+  for(long k = 0; k < ops / 100; k++) {
+    void* p = a.allocate(8);
+    a.deallocate(p, 8);
+    runs++;
+  }
+  report("8-block run, fragmented map",
+    t.seconds(), runs);
+} ///:~
@@ -0,0 +1,58 @@
+//: C13:BitmapTest.cpp
+// Bitmap searches and BitmapAllocator runs
+#include "BitmapAllocator.h"
+#include "../require.h"
+#include <iostream>
+#include <vector>
+using namespace std;
+
+int main() {
+  // 200 bits: the last word is part padding
+  Bitmap b(200);
+  require(b.count() == 0 && b.findFree() == 0);
+  b.set(0, 130); // Spans three words
+  require(b.count() == 130);
+  require(b.test(129) && !b.test(130));
+  require(b.findFree() == 130);
+  require(b.findFree(150) == 150);
+  b.set(130, 70);
+  require(b.findFree() == Bitmap::npos);
+  // Wraps around to a free bit before hint:
+  b.clear(5);
+  require(b.findFree(100) == 5);
+  b.clear(64, 10);
+  require(b.isFree(64, 10) && !b.isFree(63, 2));
+  require(b.findFreeRun(10) == 64);
+  require(b.findFreeRun(11) == Bitmap::npos);
+  require(b.findFreeRun(1, 70) == 70);
+  require(b.findFreeRun(3, 190) == 64);
+  b.clear(0, 200);
+  require(b.findFreeRun(200) == 0);
+  require(b.findFreeRun(201) == Bitmap::npos);
+
+  BitmapAllocator<32> a(1000);
+  vector<char*> v;
+  for(int i = 0; i < 1000; i++)
+    v.push_back((char*)a.allocate());
+  require(a.used() == 1000);
+  for(int i = 1; i < 1000; i++)
+    require(v[i] == v[i - 1] + 32);
+  // Free a scattered set and a hole of 8:
+  for(int i = 0; i < 1000; i += 3) {
+    a.deallocate(v[i]);
+    v[i] = 0;
+  }
+  for(int i = 500; i < 508; i++)
+    if(v[i]) { a.deallocate(v[i]); v[i] = 0; }
+  char* run = (char*)a.allocate(8);
+  require(run == v[499] + 32, "Run not found");
+  require(a.bitmap().findFreeRun(8) ==
+    Bitmap::npos);
+  bool threw = false;
+  try { a.allocate(4); }
+  catch(bad_alloc&) { threw = true; }
+  require(threw);
+  a.deallocate(run, 8);
+  cout << "Bitmap for 1000 blocks: "
+       << a.bitmap().bytes() << " bytes" << endl;
+} ///:~
@@ -0,0 +1,311 @@
+//: C13:DebugNew.cpp {O}
+// Guarded operator new for debug builds
+// Link this in to replace the global operator
+// new and delete with versions that put a
+// header and canaries around every block and
+// check them on delete, catching overruns,
+// delete of a new[] block (and the reverse),
+// double deletes, and delete of memory that
+// new didn't allocate. On glibc, free() is
+// also replaced, to catch free() of memory
+// from new; other calls go to __libc_free.
+// With DEBUGNEW off (NDEBUG) this file is
+// empty. Can't be combined with another
+// global operator new (SizeClassNew).
+#include "DebugNew.h"
+#if DEBUGNEW
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+using namespace std;
+
+#if defined(__GLIBC__)
+extern "C" void __libc_free(void*);
+#define DEBUGNEW_FREE 1
+inline void realFree(void* p) { __libc_free(p); }
+#else
+inline void realFree(void* p) { std::free(p); }
+#endif
+
+namespace {
+const uint32_t scalarMagic = 0x5CA1A12B,
+  arrayMagic = 0xA11A7B10, freedMagic = 0xDEADF12E;
+const uint64_t canary = 0xC0FFEE0DDBA11ADEULL;
+const unsigned char freedFill = 0xDD,
+  newFill = 0xCD;
+
+// Before every block, keeping the alignment
+// malloc gives:
+struct alignas(alignof(max_align_t)) Header {
+  size_t size;
+  uint32_t magic;
+  uint32_t pad;
+  uint64_t serial; // Allocation number
+  uint64_t front; // Canary, just below the data
+};
+static_assert(sizeof(Header) ==
+  offsetof(Header, front) + sizeof(uint64_t),
+  "Padding between the canary and the data");
+// A second canary follows the data, unaligned.
+
+void defaultHandler(const char* what, void* p) {
+  fprintf(stderr, "DebugNew: %s (%p)\n", what, p);
+  abort();
+}
+atomic<DebugNewHandler> handler(defaultHandler);
+
+// The live blocks, so a pointer can be checked
+// before its header is read. Open addressing;
+// its storage comes from malloc and goes back
+// to realFree, never through operator new:
+mutex tableLock;
+void** table = 0;
+size_t capacity = 0, used = 0, live = 0;
+atomic<uint64_t> serial(0);
+void* const tombstone = (void*)1;
+
+size_t slot(void* p) {
+  uintptr_t h = (uintptr_t)p;
+  h ^= h >> 17;
+  h *= 0x9E3779B97F4A7C15ULL;
+  return h & (capacity - 1);
+}
+void** find(void* p) {
+  if(!capacity) return 0;
+  for(size_t i = slot(p);; i = (i + 1) &
+      (capacity - 1)) {
+    if(table[i] == p) return &table[i];
+    if(!table[i]) return 0;
+  }
+}
+void insert(void* p);
+void rehash(size_t newCap) {
+  void** old = table;
+  size_t oldCap = capacity;
+  table = (void**)calloc(newCap, sizeof(void*));
+  if(!table) {
+    table = old;
+    return; // Stay overfull rather than fail
+  }
+  capacity = newCap;
+  used = 0;
+  for(size_t i = 0; i < oldCap; i++)
+    if(old[i] && old[i] != tombstone)
+      insert(old[i]);
+  realFree(old);
+}
+void insert(void* p) {
+  if((used + 1) * 2 > capacity)
+    rehash(capacity ? capacity * 2 : 1024);
+  size_t i = slot(p);
+  while(table[i] && table[i] != tombstone)
+    i = (i + 1) & (capacity - 1);
+  if(!table[i]) used++;
+  table[i] = p;
+}
+
+// Recently freed blocks are held back, still
+// marked freed, so a second delete is named as
+// such, and writes after the free are found
+// when a block leaves the queue:
+const int quarantineSize = 256;
+Header* quarantine[quarantineSize];
+int qNext = 0;
+
+bool inQuarantine(void* p) {
+  for(int i = 0; i < quarantineSize; i++)
+    if(quarantine[i] && 
+       (void*)(quarantine[i] + 1) == p)
+      return true;
+  return false;
+}
+
+// Called with lock held. Returns the evicted
+// block if it was written after its delete:
+void* retire(Header* h) {
+  Header* old = quarantine[qNext];
+  quarantine[qNext] = h;
+  qNext = (qNext + 1) % quarantineSize;
+  if(!old) return 0;
+  unsigned char* d = (unsigned char*)(old + 1);
+  void* bad = 0;
+  for(size_t i = 0; i < old->size; i++)
+    if(d[i] != freedFill) {
+      bad = d;
+      break;
+    }
+  realFree(old);
+  return bad;
+}
+
+bool damaged(Header* h) {
+  uint64_t back;
+  memcpy(&back, (char*)(h + 1) + h->size,
+    sizeof back);
+  return h->front != canary || back != canary;
+}
+
+void* allocate(size_t sz, uint32_t magic) {
+  for(;;) {
+    if(sz <= ~size_t(0) - sizeof(Header) - 8) {
+      Header* h = (Header*)malloc(
+        sizeof(Header) + sz + sizeof(canary));
+      if(h) {
+        h->size = sz;
+        h->magic = magic;
+        h->pad = 0;
+        h->serial = ++serial;
+        h->front = canary;
+        memcpy((char*)(h + 1) + sz, &canary,
+          sizeof canary);
+        // Uninitialized use shows up as 0xCD:
+        memset(h + 1, newFill, sz);
+        lock_guard<mutex> g(tableLock);
+        insert(h + 1);
+        live++;
+        return h + 1;
+      }
+    }
+    new_handler nh = get_new_handler();
+    if(!nh) throw bad_alloc();
+    nh();
+  }
+}
+
+// Called with lock held; 0 if p may be freed:
+const char* check(void* p, uint32_t magic,
+  size_t sized) {
+  if(!find(p))
+    return inQuarantine(p) ? "deleted twice" :
+      "delete of memory not from operator new";
+  Header* h = (Header*)p - 1;
+  if(h->magic != magic)
+    return magic == scalarMagic ?
+      "delete of memory from new[]" :
+      "delete[] of memory from new";
+  if(damaged(h))
+    return "canary overwritten: buffer "
+      "overrun or underrun";
+  if(sized && sized != h->size)
+    return "sized delete with the wrong size";
+  return 0;
+}
+
+// The handler is called without the lock, so
+// it may allocate:
+void deallocate(void* p, uint32_t magic,
+  size_t sized = 0) {
+  if(!p) return;
+  const char* error;
+  void* overwritten = 0;
+  {
+    lock_guard<mutex> g(tableLock);
+    error = check(p, magic, sized);
+    if(!error) {
+      *find(p) = tombstone;
+      live--;
+      Header* h = (Header*)p - 1;
+      h->magic = freedMagic;
+      memset(p, freedFill, h->size);
+      overwritten = retire(h);
+    }
+  }
+  if(error) handler.load()(error, p);
+  if(overwritten)
+    handler.load()("write after delete",
+      overwritten);
+}
+} // namespace
+
+DebugNewHandler setDebugNewHandler(
+  DebugNewHandler h) {
+  return handler.exchange(
+    h ? h : defaultHandler);
+}
+
+size_t debugNewLive() {
+  lock_guard<mutex> g(tableLock);
+  return live;
+}
+
+size_t debugNewCheckAll() {
+  // Report the first few after the scan:
+  const size_t shown = 16;
+  void* found[shown];
+  size_t bad = 0;
+  {
+    lock_guard<mutex> g(tableLock);
+    for(size_t i = 0; i < capacity; i++)
+      if(table[i] && table[i] != tombstone &&
+         damaged((Header*)table[i] - 1)) {
+        if(bad < shown) found[bad] = table[i];
+        bad++;
+      }
+  }
+  for(size_t i = 0; i < bad && i < shown; i++)
+    handler.load()("canary overwritten", found[i]);
+  return bad;
+}
+
+#ifdef DEBUGNEW_FREE
+// free() of a block from new is an error;
+// anything else is the C library's:
+extern "C" void free(void* p) {
+  if(!p) return;
+  bool fromNew;
+  {
+    lock_guard<mutex> g(tableLock);
+    fromNew = find(p) != 0;
+  }
+  if(fromNew)
+    handler.load()("free() of memory from new", p);
+  else
+    __libc_free(p);
+}
+#endif
+
+void* operator new(size_t sz) {
+  return allocate(sz, scalarMagic);
+}
+void* operator new[](size_t sz) {
+  return allocate(sz, arrayMagic);
+}
+void* operator new(size_t sz,
+  const nothrow_t&) noexcept {
+  try { return allocate(sz, scalarMagic); }
+  catch(...) { return 0; }
+}
+void* operator new[](size_t sz,
+  const nothrow_t&) noexcept {
+  try { return allocate(sz, arrayMagic); }
+  catch(...) { return 0; }
+}
+void operator delete(void* p) noexcept {
+  deallocate(p, scalarMagic);
+}
+void operator delete[](void* p) noexcept {
+  deallocate(p, arrayMagic);
+}
+void operator delete(void* p, size_t sz) noexcept {
+  deallocate(p, scalarMagic, sz);
+}
+void operator delete[](void* p,
+  size_t) noexcept {
+  // The size passed for arrays may include
+  // the compiler's cookie; not checked
+  deallocate(p, arrayMagic);
+}
+void operator delete(void* p,
+  const nothrow_t&) noexcept {
+  deallocate(p, scalarMagic);
+}
+void operator delete[](void* p,
+  const nothrow_t&) noexcept {
+  deallocate(p, arrayMagic);
+}
+#endif // DEBUGNEW ///:~
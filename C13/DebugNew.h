@@ -0,0 +1,43 @@
+//: C13:DebugNew.h
+// Checks from the debug operator new, if built in
+#ifndef DEBUGNEW_H
+#define DEBUGNEW_H
+#include <cstddef>
+
+// On unless NDEBUG is defined; -DDEBUGNEW=0 or
+// =1 overrides. When off, DebugNew.cpp is
+// empty, the library's operator new is used,
+// and these compile to nothing:
+#ifndef DEBUGNEW
+#ifdef NDEBUG
+#define DEBUGNEW 0
+#else
+#define DEBUGNEW 1
+#endif
+#endif
+
+// Called with a description of each error
+// found. The default prints it and aborts; a
+// handler that returns abandons the bad call
+// (the block is not freed):
+typedef void (*DebugNewHandler)(
+  const char* what, void* p);
+
+#if DEBUGNEW
+DebugNewHandler setDebugNewHandler(
+  DebugNewHandler h);
+// Blocks currently allocated:
+std::size_t debugNewLive();
+// Check the canaries of every live block now,
+// rather than when each is freed. Returns the
+// number of damaged blocks:
+std::size_t debugNewCheckAll();
+#else
+inline DebugNewHandler setDebugNewHandler(
+  DebugNewHandler h) { return h; }
+inline std::size_t debugNewLive() { return 0; }
+inline std::size_t debugNewCheckAll() { 
+  return 0; 
+}
+#endif
+#endif // DEBUGNEW_H ///:~
@@ -0,0 +1,143 @@
+//: C13:DebugNewTest.cpp
+//{L} DebugNew
+// Each error the debug operator new catches
+#include "DebugNew.h"
+#include "../require.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Errors are recorded, not fatal:
+string lastError;
+void* lastPointer = 0;
+void record(const char* what, void* p) {
+  lastError = what;
+  lastPointer = p;
+}
+// Expect exactly this error from the last call:
+void expect(const char* what, void* p) {
+  require(lastError == what,
+    ("Expected: " + string(what) + ", got: " +
+     lastError).c_str());
+  require(lastPointer == p, "Wrong pointer");
+  lastError.clear();
+  lastPointer = 0;
+}
+void expectNone() {
+  require(lastError.empty(), lastError.c_str());
+}
+
+// Stops the compiler from pairing up (or
+// eliding) each new with its delete:
+template<class T>
+__attribute__((noinline)) T* opaque(T* p) {
+  T* volatile v = p;
+  return v;
+}
+
+int main() {
+#if DEBUGNEW
+  setDebugNewHandler(record);
+  size_t before = debugNewLive();
+  // Good use passes silently:
+  int* i = opaque(new int(47));
+  char* s = opaque(new char[10]);
+  require(debugNewLive() == before + 2,
+    "Live count wrong");
+  require(*i == 47);
+  delete i;
+  delete []s;
+  expectNone();
+  require(debugNewLive() == before);
+  // new[] released with delete, and the
+  // reverse. The block is left alone:
+  int* a = opaque(new int[4]);
+  delete opaque(a);
+  expect("delete of memory from new[]", a);
+  delete []a;
+  expectNone();
+  double* d = opaque(new double);
+  delete []opaque(d);
+  expect("delete[] of memory from new", d);
+  delete d;
+  expectNone();
+  // Writing past either end:
+  char* buf = opaque(new char[16]);
+  char saved = buf[16];
+  buf[16] = 'x';
+  require(debugNewCheckAll() == 1,
+    "Overrun not found");
+  expect("canary overwritten", buf);
+  delete []opaque(buf);
+  expect("canary overwritten: buffer "
+    "overrun or underrun", buf);
+  buf[16] = saved; // Repair it
+  saved = buf[-1];
+  buf[-1] = 'x';
+  delete []opaque(buf);
+  expect("canary overwritten: buffer "
+    "overrun or underrun", buf);
+  buf[-1] = saved;
+  delete []opaque(buf);
+  expectNone();
+  // Deleting twice:
+  int* twice = opaque(new int);
+  delete twice;
+  delete opaque(twice);
+  expect("deleted twice", twice);
+  // Memory new never handed out:
+  void* m = malloc(8);
+  delete opaque((char*)m);
+  expect("delete of memory not from "
+    "operator new", m);
+  int local;
+  delete opaque(&local);
+  expect("delete of memory not from "
+    "operator new", &local);
+  free(m);
+  expectNone();
+#ifdef __GLIBC__
+  // free() of memory from new:
+  int* fromNew = opaque(new int);
+  free(opaque(fromNew));
+  expect("free() of memory from new", fromNew);
+  delete opaque(fromNew);
+  expectNone();
+#endif
+  // Sized delete with the wrong size:
+  long* l = opaque(new long);
+  operator delete(opaque(l), sizeof(long) * 2);
+  expect("sized delete with the wrong size", l);
+  operator delete(opaque(l), sizeof(long));
+  expectNone();
+  // New memory is filled, to show up unset
+  // fields; freed memory too:
+  unsigned char* u = opaque(new unsigned char[8]);
+  require(u[3] == 0xCD, "New memory not filled");
+  delete []u;
+  // A write after delete is found when the
+  // block leaves quarantine:
+  char* late = opaque(new char[8]);
+  delete []late;
+  late[2] = 'x';
+  for(int n = 0; n < 1000 && lastError.empty();
+      n++)
+    delete opaque(new int);
+  expect("write after delete", late);
+  // Library code works as usual:
+  vector<string> v;
+  for(int n = 0; n < 1000; n++)
+    v.push_back(string(40, 'a' + n % 26));
+  v.clear();
+  v.shrink_to_fit();
+  expectNone();
+  require(debugNewCheckAll() == 0);
+  cout << "DebugNew: all errors caught" << endl;
+#else
+  cout << "DebugNew is off in this build" << endl;
+  require(debugNewLive() == 0);
+#endif
+} ///:~
@@ -0,0 +1,140 @@
+//: C13:FixedPool.h
+// O(1) fixed-size block pool, and a mixin to use it
+#ifndef FIXEDPOOL_H
+#define FIXEDPOOL_H
+#include "../require.h"
+#include <cstddef>
+#include <new>
+
+// Pointer ownership checks on deallocate(),
+// on in debug builds:
+#ifndef FIXEDPOOL_CHECKS
+#ifdef NDEBUG
+#define FIXEDPOOL_CHECKS 0
+#else
+#define FIXEDPOOL_CHECKS 1
+#endif
+#endif
+
+// Blocks the size of a T, carved from Chunks of
+// N. A free block holds the pointer to the next
+// free one, so allocate() and deallocate() just
+// pop and push the head of that list, instead
+// of scanning a map the way Framis does. With
+// Grow false the pool stops at one Chunk and
+// then throws bad_alloc. Not thread-safe.
+template<class T, std::size_t N = 100,
+  bool Grow = true>
+class FixedPool {
+  union Node {
+    Node* next;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+  struct Chunk {
+    Chunk* next;
+    Node nodes[N];
+  };
+  Node* freeList;
+  Chunk* chunks;
+  std::size_t nChunks, used;
+  void addChunk() {
+    Chunk* c = new Chunk;
+    c->next = chunks;
+    chunks = c;
+    nChunks++;
+    // Thread in reverse so blocks are handed
+    // out in address order:
+    for(std::size_t i = N; i > 0; i--) {
+      c->nodes[i - 1].next = freeList;
+      freeList = &c->nodes[i - 1];
+    }
+  }
+  FixedPool(const FixedPool&);
+  void operator=(const FixedPool&);
+public:
+  static_assert(N > 0, "FixedPool needs N > 0");
+  enum { blockSize = sizeof(Node) };
+  FixedPool()
+    : freeList(0), chunks(0), nChunks(0),
+      used(0) {}
+  // Releases the Chunks whether or not their
+  // blocks are still in use:
+  ~FixedPool() {
+    while(chunks) {
+      Chunk* next = chunks->next;
+      delete chunks;
+      chunks = next;
+    }
+  }
+  void* allocate() {
+    if(!freeList) {
+      if(!Grow && nChunks > 0)
+        throw std::bad_alloc();
+      addChunk();
+    }
+    Node* n = freeList;
+    freeList = n->next;
+    used++;
+    return n;
+  }
+  void deallocate(void* p) {
+    if(!p) return;
+#if FIXEDPOOL_CHECKS
+    require(owns(p),
+      "FixedPool: pointer not from this pool");
+#endif
+    Node* n = (Node*)p;
+    n->next = freeList;
+    freeList = n;
+    used--;
+  }
+  // True if p is the start of one of this
+  // pool's blocks. O(number of Chunks):
+  bool owns(const void* p) const {
+    const char* cp = (const char*)p;
+    for(Chunk* c = chunks; c; c = c->next) {
+      const char* first = (const char*)c->nodes;
+      if(cp >= first &&
+         cp < first + sizeof(c->nodes))
+        return (cp - first) % sizeof(Node) == 0;
+    }
+    return false;
+  }
+  std::size_t inUse() const { return used; }
+  std::size_t capacity() const {
+    return nChunks * N;
+  }
+  std::size_t chunkCount() const {
+    return nChunks;
+  }
+};
+
+// One line adopts the pool: derive from
+// Pooled<YourClass>. Only objects of exactly
+// sizeof(T) come from the pool; a derived
+// class that's larger gets the global heap.
+// The pool is never destroyed, so objects
+// deleted during static destruction are safe:
+template<class T, std::size_t N = 100,
+  bool Grow = true>
+class Pooled {
+public:
+  typedef FixedPool<T, N, Grow> Pool;
+  static Pool& pool() {
+    static Pool& p = *new Pool;
+    return p;
+  }
+  static void* operator new(std::size_t sz) {
+    if(sz != sizeof(T))
+      return ::operator new(sz);
+    return pool().allocate();
+  }
+  static void operator delete(void* p,
+    std::size_t sz) {
+    if(sz != sizeof(T))
+      ::operator delete(p);
+    else
+      pool().deallocate(p);
+  }
+};
+#endif // FIXEDPOOL_H ///:~
@@ -0,0 +1,71 @@
+//: C13:FixedPoolBench.cpp
+// FixedPool vs. Framis's linear scan vs. malloc
+#include "FixedPool.h"
+#include "../bench.h"
+#include <cstdlib>
+#include <new>
+#include <vector>
+using namespace std;
+const int psize = 1000;
+
+// Framis's scheme, minus the logging:
+class Scanned {
+  char c[16];
+  static unsigned char pool[];
+  static bool alloc_map[];
+public:
+  void* operator new(size_t) {
+    for(int i = 0; i < psize; i++)
+      if(!alloc_map[i]) {
+        alloc_map[i] = true;
+        return pool + (i * sizeof(Scanned));
+      }
+    throw bad_alloc();
+  }
+  void operator delete(void* m) {
+    if(!m) return;
+    alloc_map[((unsigned char*)m - pool) /
+      sizeof(Scanned)] = false;
+  }
+};
+alignas(Scanned) unsigned char 
+  Scanned::pool[psize * sizeof(Scanned)];
+bool Scanned::alloc_map[psize] = {false};
+
+class Pool : public Pooled<Pool, psize, false> {
+  char c[16];
+};
+class Heap {
+  char c[16];
+};
+
+// Fill the pool to 90%, then free and
+// reallocate random blocks, so the scan
+// has to search a mostly full map:
+template<class T>
+double churn(long ops) {
+  vector<T*> live(psize * 9 / 10);
+  for(auto& p : live) p = new T;
+  unsigned r = 12345;
+  Timer t;
+  for(long i = 0; i < ops; i++) {
+    r = r * 1103515245 + 12345;
+    T*& p = live[(r >> 8) % live.size()];
+    delete p;
+    p = new T;
+  }
+  double secs = t.seconds();
+  keep(live[0]);
+  for(auto p : live) delete p;
+  return secs;
+}
+
+int main(int argc, char* argv[]) {
+  long ops = benchArg(argc, argv, 1, 2000000);
+  report("linear scan (Framis)",
+    churn<Scanned>(ops), ops);
+  report("FixedPool free list",
+    churn<Pool>(ops), ops);
+  report("malloc (global new)",
+    churn<Heap>(ops), ops);
+} ///:~
@@ -0,0 +1,72 @@
+//: C13:FixedPoolTest.cpp
+// FixedPool growth, reuse and ownership
+#include "FixedPool.h"
+#include "../require.h"
+#include <iostream>
+#include <new>
+#include <vector>
+using namespace std;
+
+// Framis with a bounded pool, in one line:
+class Framis : public Pooled<Framis, 100, false> {
+  char c[10];
+};
+
+class Node : public Pooled<Node, 64> {
+public:
+  Node* next;
+  double weight;
+  Node(Node* n = 0) : next(n), weight(1) {}
+  virtual ~Node() {}
+};
+
+// Bigger than Node, so it uses the heap:
+class BigNode : public Node {
+  char payload[100];
+};
+
+int main() {
+  vector<Framis*> f;
+  for(int i = 0; i < 100; i++)
+    f.push_back(new Framis);
+  require(Framis::pool().inUse() == 100);
+  bool threw = false;
+  try {
+    new Framis;
+  } catch(bad_alloc&) {
+    threw = true;
+  }
+  require(threw, "Bounded pool should be full");
+  // A freed block is the next one handed out:
+  Framis* tenth = f[10];
+  delete f[10];
+  f[10] = new Framis;
+  require(f[10] == tenth, "Block not reused");
+  for(Framis* p : f) delete p;
+  require(Framis::pool().inUse() == 0);
+  // Growth by Chunks:
+  Node* list = 0;
+  for(int i = 0; i < 1000; i++)
+    list = new Node(list);
+  Node::Pool& np = Node::pool();
+  require(np.inUse() == 1000);
+  require(np.chunkCount() == 1000 / 64 + 1);
+  require(np.owns(list));
+  int dummy = 0;
+  require(!np.owns(&dummy));
+  require(!np.owns((char*)list + 1));
+  // Derived classes of another size bypass it:
+  Node* big = new BigNode;
+  require(!np.owns(big));
+  require(np.inUse() == 1000);
+  delete big;
+  while(list) {
+    Node* next = list->next;
+    delete list;
+    list = next;
+  }
+  require(np.inUse() == 0);
+  cout << "FixedPool: " << np.capacity()
+       << " blocks of " << Node::Pool::blockSize
+       << " bytes" << endl;
+} ///:~
@@ -0,0 +1,231 @@
+//: C13:MagazinePool.h
+// Block pool with per-thread magazine caches
+#ifndef MAGAZINEPOOL_H
+#define MAGAZINEPOOL_H
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Blocks of Size bytes. Each thread keeps two
+// magazines (arrays of up to MagSize free
+// blocks) and allocates and frees against them
+// without locking. Only when both are empty (or
+// both full) does it visit the central depot,
+// under its mutex, trading a whole magazine at
+// once. Any thread may free any block: the
+// block just joins that thread's magazine, so
+// memory migrates between threads instead of
+// needing to be sent home.
+//
+// A thread's magazines go back to the depot
+// when it exits, or on flushThread(). A pool
+// must outlive every thread that has used it.
+template<std::size_t Size,
+  std::size_t Align = alignof(std::max_align_t),
+  std::size_t MagSize = 64>
+class MagazinePool {
+  static_assert((Align & (Align - 1)) == 0,
+    "Align must be a power of two");
+  struct Magazine {
+    Magazine* next;
+    std::size_t n;
+    void* items[MagSize];
+  };
+  // A thread's pair of magazines. Allocation
+  // and free use loaded; previous saves a trip
+  // to the depot when a thread alternates
+  // around a magazine boundary:
+  struct Cache {
+    MagazinePool* pool;
+    Magazine* loaded;
+    Magazine* previous;
+  };
+  // All of one thread's Caches, returned to
+  // their pools when the thread exits:
+  struct ThreadCaches {
+    std::vector<Cache> caches;
+    ~ThreadCaches() {
+      for(Cache& c : caches)
+        if(c.pool) c.pool->flush(c);
+    }
+  };
+  static ThreadCaches& threadCaches() {
+    thread_local ThreadCaches tc;
+    return tc;
+  }
+  static std::size_t nextIndex() {
+    static std::atomic<std::size_t> n{0};
+    return n++;
+  }
+  enum { 
+    stride = (Size + Align - 1) / Align * Align,
+    chunkMagazines = 16 // Per growth step
+  };
+  const std::size_t index;
+  std::mutex lock; // Guards everything below
+  Magazine* full;
+  Magazine* empty;
+  std::vector<void*> chunks;
+  std::size_t nBlocks;
+  static void push(Magazine*& list, Magazine* m) {
+    m->next = list;
+    list = m;
+  }
+  static Magazine* pop(Magazine*& list) {
+    Magazine* m = list;
+    if(m) list = m->next;
+    return m;
+  }
+  // Called with lock held: carve a new chunk
+  // into full magazines:
+  void grow() {
+    const std::size_t n = chunkMagazines * MagSize;
+    char* p = (char*)::operator new(n * stride,
+      std::align_val_t(Align));
+    chunks.push_back(p);
+    nBlocks += n;
+    for(std::size_t m = 0; m < chunkMagazines; 
+        m++) {
+      Magazine* mag = new Magazine;
+      for(std::size_t i = 0; i < MagSize; i++)
+        mag->items[i] = p + (m * MagSize +
+          (MagSize - 1 - i)) * stride;
+      mag->n = MagSize;
+      push(full, mag);
+    }
+  }
+  // Swap an empty magazine for a full one:
+  Magazine* exchangeEmpty(Magazine* m) {
+    std::lock_guard<std::mutex> g(lock);
+    if(m) push(empty, m);
+    if(!full) grow();
+    return pop(full);
+  }
+  // Swap a full magazine for an empty one:
+  Magazine* exchangeFull(Magazine* m) {
+    std::lock_guard<std::mutex> g(lock);
+    if(m) push(full, m);
+    Magazine* e = pop(empty);
+    if(!e) e = new Magazine;
+    e->n = 0;
+    return e;
+  }
+  void flush(Cache& c) {
+    std::lock_guard<std::mutex> g(lock);
+    Magazine* ms[] = { c.loaded, c.previous };
+    for(Magazine* m : ms)
+      if(m) push(m->n ? full : empty, m);
+    // Partly full magazines go on the full list;
+    // allocation copes with any count:
+    c.loaded = c.previous = 0;
+  }
+  Cache& cache() {
+    std::vector<Cache>& v = threadCaches().caches;
+    if(index >= v.size()) {
+      Cache none = { 0, 0, 0 };
+      v.resize(index + 1, none);
+    }
+    Cache& c = v[index];
+    if(!c.pool) c.pool = this;
+    return c;
+  }
+  static void freeList(Magazine* m) {
+    while(m) {
+      Magazine* next = m->next;
+      delete m;
+      m = next;
+    }
+  }
+  MagazinePool(const MagazinePool&);
+  void operator=(const MagazinePool&);
+public:
+  enum { blockSize = stride, 
+    magazineSize = MagSize };
+  MagazinePool()
+    : index(nextIndex()), full(0), empty(0),
+      nBlocks(0) {}
+  ~MagazinePool() {
+    flushThread();
+    freeList(full);
+    freeList(empty);
+    for(void* p : chunks)
+      ::operator delete(p, 
+        std::align_val_t(Align));
+  }
+  void* allocate() {
+    Cache& c = cache();
+    if(!c.loaded || c.loaded->n == 0) {
+      if(c.previous && c.previous->n > 0)
+        std::swap(c.loaded, c.previous);
+      else {
+        // Both empty: trade one for a full one
+        Magazine* spare = c.previous;
+        c.previous = c.loaded;
+        c.loaded = exchangeEmpty(spare);
+      }
+    }
+    return c.loaded->items[--c.loaded->n];
+  }
+  void deallocate(void* p) {
+    if(!p) return;
+    Cache& c = cache();
+    if(!c.loaded || c.loaded->n == MagSize) {
+      if(c.previous && c.previous->n < MagSize)
+        std::swap(c.loaded, c.previous);
+      else {
+        // Both full: trade one for an empty one
+        Magazine* spare = c.previous;
+        c.previous = c.loaded;
+        c.loaded = exchangeFull(spare);
+      }
+    }
+    c.loaded->items[c.loaded->n++] = p;
+  }
+  // Return this thread's magazines to the
+  // depot now, rather than at thread exit:
+  void flushThread() {
+    std::vector<Cache>& v = threadCaches().caches;
+    if(index < v.size() && v[index].pool) {
+      flush(v[index]);
+      v[index].pool = 0;
+    }
+  }
+  // Blocks carved so far, in use or cached:
+  std::size_t capacity() {
+    std::lock_guard<std::mutex> g(lock);
+    return nBlocks;
+  }
+};
+
+// Class-level operator new and delete backed by
+// a MagazinePool, in one line: derive from
+// ThreadPooled<YourClass>. Like Pooled in
+// FixedPool.h, other sizes use the global heap
+// and the pool is never destroyed:
+template<class T, std::size_t MagSize = 64>
+class ThreadPooled {
+public:
+  // T is complete by the time this is called:
+  static auto& pool() {
+    typedef MagazinePool<sizeof(T), alignof(T),
+      MagSize> Pool;
+    static Pool& p = *new Pool;
+    return p;
+  }
+  static void* operator new(std::size_t sz) {
+    if(sz != sizeof(T))
+      return ::operator new(sz);
+    return pool().allocate();
+  }
+  static void operator delete(void* p,
+    std::size_t sz) {
+    if(sz != sizeof(T))
+      ::operator delete(p);
+    else
+      pool().deallocate(p);
+  }
+};
+#endif // MAGAZINEPOOL_H ///:~
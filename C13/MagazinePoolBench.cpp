@@ -0,0 +1,115 @@
+//: C13:MagazinePoolBench.cpp
+// Multithreaded alloc/free: locked vs. magazines
+#include "MagazinePool.h"
+#include "FixedPool.h"
+#include "../bench.h"
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+const size_t blockSize = 64;
+struct Block { char c[blockSize]; };
+
+struct GlobalHeap {
+  void* allocate() { 
+    return ::operator new(blockSize); 
+  }
+  void deallocate(void* p) { 
+    ::operator delete(p); 
+  }
+};
+
+// What a class-level pool would need to be
+// shared: one lock around every call:
+struct LockedPool {
+  FixedPool<Block, 1024> pool;
+  mutex m;
+  void* allocate() {
+    lock_guard<mutex> g(m);
+    return pool.allocate();
+  }
+  void deallocate(void* p) {
+    lock_guard<mutex> g(m);
+    pool.deallocate(p);
+  }
+};
+
+struct Magazines {
+  MagazinePool<blockSize> pool;
+  void* allocate() { return pool.allocate(); }
+  void deallocate(void* p) { 
+    pool.deallocate(p); 
+  }
+};
+
+// Each thread allocates a burst and frees it;
+// a fraction of each burst is freed by the
+// next thread instead (cross-thread frees):
+template<class Alloc>
+double run(int nThreads, long perThread,
+  int burst, bool cross) {
+  Alloc a;
+  vector<vector<void*> > handoff(nThreads);
+  vector<mutex> locks(nThreads);
+  vector<thread> threads;
+  Timer t;
+  for(int id = 0; id < nThreads; id++)
+    threads.emplace_back([&, id] {
+      vector<void*> mine(burst), theirs;
+      for(long i = 0; i < perThread; 
+          i += burst) {
+        for(auto& p : mine) p = a.allocate();
+        int k = 0;
+        if(cross) {
+          // Pass a quarter on; free what was
+          // passed to us:
+          lock_guard<mutex> g(
+            locks[(id + 1) % nThreads]);
+          vector<void*>& h = 
+            handoff[(id + 1) % nThreads];
+          for(; k < burst / 4; k++)
+            h.push_back(mine[k]);
+        }
+        for(int j = k; j < burst; j++)
+          a.deallocate(mine[j]);
+        if(cross) {
+          {
+            lock_guard<mutex> g(locks[id]);
+            theirs.swap(handoff[id]);
+          }
+          for(void* p : theirs) a.deallocate(p);
+          theirs.clear();
+        }
+      }
+    });
+  for(auto& th : threads) th.join();
+  double secs = t.seconds();
+  for(auto& h : handoff)
+    for(void* p : h) a.deallocate(p);
+  return secs;
+}
+
+template<class Alloc>
+void row(const char* name, int n, long ops,
+  bool cross) {
+  char label[64];
+  snprintf(label, sizeof label, "  %s", name);
+  report(label, run<Alloc>(n, ops / n, 32, 
+    cross), ops);
+}
+
+int main(int argc, char* argv[]) {
+  long ops = benchArg(argc, argv, 1, 4000000);
+  printf("%u hardware threads\n",
+    thread::hardware_concurrency());
+  for(int cross = 0; cross < 2; cross++)
+    for(int n = 1; n <= 8; n *= 2) {
+      printf("%d threads%s:\n", n, 
+        cross ? ", 1/4 freed elsewhere" : "");
+      row<GlobalHeap>("global new", n, ops, cross);
+      row<LockedPool>("locked FixedPool", n, ops, 
+        cross);
+      row<Magazines>("MagazinePool", n, ops, cross);
+    }
+} ///:~
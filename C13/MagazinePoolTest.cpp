@@ -0,0 +1,78 @@
+//: C13:MagazinePoolTest.cpp
+// Per-thread caching and cross-thread frees
+#include "MagazinePool.h"
+#include "../require.h"
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <vector>
+using namespace std;
+
+class Widget : public ThreadPooled<Widget, 16> {
+  int i[10];
+public:
+  Widget(int n = 0) { i[0] = n; }
+  int value() const { return i[0]; }
+};
+
+int main() {
+  typedef MagazinePool<24, 8, 8> Pool;
+  Pool pool;
+  // Blocks are distinct and aligned, across
+  // several magazine and depot trips:
+  vector<void*> v;
+  for(int i = 0; i < 1000; i++)
+    v.push_back(pool.allocate());
+  require(set<void*>(v.begin(), v.end()).size()
+    == v.size(), "Block handed out twice");
+  for(void* p : v)
+    require((size_t)p % 8 == 0);
+  size_t cap = pool.capacity();
+  for(void* p : v) pool.deallocate(p);
+  // Freed blocks are reused, not new ones:
+  for(int i = 0; i < 1000; i++)
+    v[i] = pool.allocate();
+  require(pool.capacity() == cap);
+  // Freed on another thread, which returns
+  // its magazines to the depot at exit:
+  thread([&] {
+    for(void* p : v) pool.deallocate(p);
+  }).join();
+  vector<void*> again;
+  for(int i = 0; i < 1000; i++)
+    again.push_back(pool.allocate());
+  require(pool.capacity() == cap,
+    "Cross-thread frees were lost");
+  for(void* p : again) pool.deallocate(p);
+  // Producers allocate, consumers free:
+  const int nThreads = 4, perThread = 20000;
+  vector<vector<Widget*>> made(nThreads);
+  vector<thread> threads;
+  for(int t = 0; t < nThreads; t++)
+    threads.emplace_back([&made, t] {
+      for(int i = 0; i < perThread; i++)
+        made[t].push_back(new Widget(i));
+    });
+  for(auto& th : threads) th.join();
+  threads.clear();
+  for(int t = 0; t < nThreads; t++)
+    threads.emplace_back([&made, t] {
+      vector<Widget*>& mine = 
+        made[(t + 1) % nThreads];
+      for(int i = 0; i < perThread; i++) {
+        require(mine[i]->value() == i);
+        delete mine[i];
+      }
+    });
+  for(auto& th : threads) th.join();
+  size_t wcap = Widget::pool().capacity();
+  // All of it is back in the depot:
+  vector<Widget*> w;
+  for(int i = 0; i < nThreads * perThread; i++)
+    w.push_back(new Widget);
+  require(Widget::pool().capacity() == wcap);
+  for(Widget* p : w) delete p;
+  cout << "MagazinePool: " << wcap 
+       << " Widget blocks" << endl;
+} ///:~
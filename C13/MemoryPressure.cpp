@@ -0,0 +1,153 @@
+//: C13:MemoryPressure.cpp {O}
+// Releaser registry, new_handler and RSS watch
+#include "MemoryPressure.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fcntl.h>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+using namespace std;
+
+namespace {
+struct Entry {
+  int id, priority;
+  MemoryPressure::Releaser release;
+};
+
+struct Registry {
+  mutex lock;
+  vector<Entry> entries; // By priority
+  int nextId = 0;
+  atomic<size_t> perFailure{0};
+  atomic<size_t> limit{0};
+  // The watcher:
+  mutex watchLock;
+  condition_variable stop;
+  bool stopping = false;
+  thread watcher;
+  // Works on *this, so the destructor needn't
+  // call registry() while it is being torn down:
+  void stopWatcher() {
+    if(!watcher.joinable()) return;
+    {
+      lock_guard<mutex> g(watchLock);
+      stopping = true;
+    }
+    stop.notify_all();
+    watcher.join();
+  }
+  ~Registry() { stopWatcher(); }
+};
+
+Registry& registry() {
+  static Registry r;
+  return r;
+}
+
+// Set while this thread runs Releasers, so an
+// allocation failing inside one doesn't recurse:
+thread_local bool relieving = false;
+
+void handler() {
+  Registry& r = registry();
+  if(relieving ||
+     MemoryPressure::relieve(r.perFailure) == 0)
+    throw bad_alloc();
+}
+} // namespace
+
+int MemoryPressure::add(int priority, 
+  Releaser rel) {
+  Registry& r = registry();
+  lock_guard<mutex> g(r.lock);
+  Entry e = { r.nextId++, priority, rel };
+  // After any of equal priority:
+  auto at = upper_bound(r.entries.begin(),
+    r.entries.end(), priority,
+    [](int p, const Entry& x) {
+      return p < x.priority; });
+  r.entries.insert(at, e);
+  return e.id;
+}
+
+void MemoryPressure::remove(int id) {
+  Registry& r = registry();
+  lock_guard<mutex> g(r.lock);
+  r.entries.erase(remove_if(r.entries.begin(),
+    r.entries.end(), [id](const Entry& e) {
+      return e.id == id; }), r.entries.end());
+}
+
+size_t MemoryPressure::relieve(size_t want) {
+  Registry& r = registry();
+  lock_guard<mutex> g(r.lock);
+  relieving = true;
+  size_t freed = 0;
+  try {
+    for(size_t i = 0; i < r.entries.size() &&
+        freed < want; i++)
+      freed += r.entries[i].release(want - freed);
+  } catch(...) {
+    relieving = false;
+    throw;
+  }
+  relieving = false;
+  return freed;
+}
+
+void MemoryPressure::install(size_t perFailure) {
+  registry().perFailure = perFailure;
+  set_new_handler(handler);
+}
+
+size_t MemoryPressure::rss() {
+  // open() and read(), not iostreams, so this
+  // doesn't allocate:
+  int fd = open("/proc/self/statm", O_RDONLY);
+  if(fd < 0) return 0;
+  char buf[128];
+  ssize_t n = read(fd, buf, sizeof buf - 1);
+  close(fd);
+  if(n <= 0) return 0;
+  buf[n] = 0;
+  // Fields: size resident shared ...
+  const char* p = buf;
+  while(*p && *p != ' ') p++;
+  if(!*p) return 0; // Only one field
+  size_t pages = 0;
+  for(p++; *p >= '0' && *p <= '9'; p++)
+    pages = pages * 10 + (*p - '0');
+  return pages * size_t(sysconf(_SC_PAGESIZE));
+}
+
+void MemoryPressure::softLimit(size_t bytes) {
+  registry().limit = bytes;
+}
+
+size_t MemoryPressure::poll() {
+  size_t limit = registry().limit;
+  if(!limit) return 0;
+  size_t now = rss();
+  return now > limit ? relieve(now - limit) : 0;
+}
+
+void MemoryPressure::watch(
+  chrono::milliseconds interval) {
+  stopWatching();
+  Registry& r = registry();
+  r.stopping = false;
+  r.watcher = thread([&r, interval] {
+    unique_lock<mutex> lock(r.watchLock);
+    while(!r.stop.wait_for(lock, interval,
+      [&r] { return r.stopping; }))
+      poll();
+  });
+}
+
+void MemoryPressure::stopWatching() {
+  registry().stopWatcher();
+} ///:~
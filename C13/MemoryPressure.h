@@ -0,0 +1,54 @@
+//: C13:MemoryPressure.h
+// Shrink registered caches when memory runs low
+#ifndef MEMORYPRESSURE_H
+#define MEMORYPRESSURE_H
+#include <chrono>
+#include <cstddef>
+#include <functional>
+
+// Instead of a new_handler that gives up, as
+// in NewHandler.cpp, subsystems register a
+// Releaser: asked to free about n bytes, it
+// frees what it can and returns how much.
+// Releasers run lowest priority number first,
+// so cheap-to-rebuild caches go before
+// expensive ones. Releasers run while the
+// registry is locked: they may allocate and
+// free, but must not call add() or remove().
+// Any thread may call relieve(), and watch()
+// calls it from its own thread, so a Releaser
+// must be thread-safe: lock whatever cache
+// it trims.
+class MemoryPressure {
+public:
+  typedef std::function<
+    std::size_t(std::size_t)> Releaser;
+  // Returns an id for remove():
+  static int add(int priority, Releaser r);
+  static void remove(int id);
+  // Run Releasers in priority order until
+  // want bytes are freed or all have run.
+  // Returns the bytes freed:
+  static std::size_t relieve(std::size_t want);
+  // Become the new_handler: each failed
+  // allocation asks for perFailure bytes, then
+  // operator new retries. When nothing more can
+  // be freed it throws bad_alloc:
+  static void install(
+    std::size_t perFailure = 1 << 20);
+  // Resident set size in bytes, from
+  // /proc/self/statm; 0 if unavailable:
+  static std::size_t rss();
+  // A soft limit on rss(), checked by poll()
+  // and the watcher; 0 turns it off:
+  static void softLimit(std::size_t bytes);
+  // If rss() is over the soft limit, relieve()
+  // the excess. Returns the bytes freed:
+  static std::size_t poll();
+  // A background thread that poll()s every
+  // interval, until stopWatching() or exit:
+  static void watch(
+    std::chrono::milliseconds interval);
+  static void stopWatching();
+};
+#endif // MEMORYPRESSURE_H ///:~
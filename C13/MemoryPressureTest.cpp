@@ -0,0 +1,113 @@
+//: C13:MemoryPressureTest.cpp
+//{L} MemoryPressure
+// Caches shrink instead of the program dying
+#include "MemoryPressure.h"
+#include "../require.h"
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// A cache of 1MB buffers that gives them up
+// when asked:
+class Cache {
+  vector<unique_ptr<char[]>> bufs;
+public:
+  string name;
+  atomic<size_t> calls{0};
+  Cache(const string& nm, int mb) : name(nm) {
+    for(int i = 0; i < mb; i++) {
+      bufs.emplace_back(new char[1 << 20]);
+      memset(bufs.back().get(), 1, 1 << 20);
+    }
+  }
+  size_t release(size_t want) {
+    calls++;
+    size_t freed = 0;
+    while(freed < want && !bufs.empty()) {
+      bufs.pop_back();
+      freed += 1 << 20;
+    }
+    return freed;
+  }
+  size_t size() const { return bufs.size(); }
+};
+
+int main() {
+  require(MemoryPressure::rss() > 0,
+    "No /proc/self/statm");
+  Cache cheap("cheap", 64), dear("dear", 64);
+  int d = MemoryPressure::add(10, [&](size_t n) {
+    return dear.release(n); });
+  MemoryPressure::add(1, [&](size_t n) {
+    return cheap.release(n); });
+  // Lower priority numbers go first:
+  require(MemoryPressure::relieve(4 << 20) ==
+    4 << 20);
+  require(cheap.size() == 60 && dear.size() == 64);
+  require(dear.calls == 0);
+  // The soft limit frees the excess:
+  MemoryPressure::softLimit(
+    MemoryPressure::rss() - (8 << 20));
+  require(MemoryPressure::poll() >= 8 << 20);
+  require(cheap.size() <= 52);
+  MemoryPressure::softLimit(0);
+  require(MemoryPressure::poll() == 0);
+  // A hard limit on address space makes the
+  // next big allocation fail; the handler
+  // frees caches until it fits:
+  MemoryPressure::install();
+  rlimit old, lim;
+  getrlimit(RLIMIT_AS, &old);
+  lim = old;
+  // Current mappings, roughly, plus 32MB:
+  size_t vm = 0;
+  {
+    FILE* f = fopen("/proc/self/statm", "r");
+    unsigned long pages = 0;
+    if(f && fscanf(f, "%lu", &pages) == 1)
+      vm = pages * 4096;
+    if(f) fclose(f);
+  }
+  lim.rlim_cur = vm + (32 << 20);
+  require(setrlimit(RLIMIT_AS, &lim) == 0);
+  size_t before = cheap.size() + dear.size();
+  {
+    unique_ptr<char[]> big(new char[80 << 20]);
+    memset(big.get(), 2, 80 << 20);
+  }
+  require(cheap.size() + dear.size() < before,
+    "Handler freed nothing");
+  cout << "Freed " << before - cheap.size() -
+    dear.size() << "MB to fit 80MB" << endl;
+  // Nothing left to give: bad_alloc as usual
+  MemoryPressure::remove(d);
+  bool threw = false;
+  try {
+    // Called directly; a new-expression whose
+    // result is unused may be optimized away:
+    ::operator delete(::operator new(1L << 36));
+  } catch(bad_alloc&) {
+    threw = true;
+  }
+  require(threw);
+  setrlimit(RLIMIT_AS, &old);
+  // The watcher does the polling:
+  Cache more("more", 16);
+  MemoryPressure::add(0, [&](size_t n) {
+    return more.release(n); });
+  MemoryPressure::softLimit(
+    MemoryPressure::rss() - (4 << 20));
+  MemoryPressure::watch(chrono::milliseconds(1));
+  for(int i = 0; i < 1000 && more.calls == 0; i++)
+    this_thread::sleep_for(
+      chrono::milliseconds(1));
+  MemoryPressure::stopWatching();
+  require(more.calls > 0, "Watcher never ran");
+} ///:~
@@ -0,0 +1,195 @@
+//: C13:ObjectPool.h
+// Per-type pool of small objects, kept in order
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+#include "BitmapAllocator.h"
+#include "../require.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Objects live in ChunkBytes-aligned Chunks, so
+// the Chunk of any object is found by masking
+// its address. Each Chunk's Bitmap marks the
+// slots in use. New objects go into the
+// current Chunk at the first free slot after
+// the last one handed out, so objects made one
+// after another sit next to each other. Freed
+// slots are reused before a new Chunk is added.
+// Not thread-safe.
+template<class T, std::size_t ChunkBytes = 64 * 1024>
+class ObjectPool {
+  static_assert((ChunkBytes & (ChunkBytes - 1)) == 0,
+    "ChunkBytes must be a power of two");
+  struct Chunk {
+    Chunk* next; // In creation order
+    Bitmap used;
+    std::size_t live, hint;
+    explicit Chunk(std::size_t n)
+      : next(0), used(n), live(0), hint(0) {}
+  };
+  static constexpr std::size_t slotOffset =
+    (sizeof(Chunk) + alignof(T) - 1) /
+    alignof(T) * alignof(T);
+  static_assert(ChunkBytes >= slotOffset +
+    4 * sizeof(T), "ChunkBytes too small for T");
+  static_assert(alignof(T) <= ChunkBytes,
+    "T is aligned beyond ChunkBytes");
+  Chunk* first;
+  Chunk* last;
+  Chunk* current; // Where allocation happens
+  std::size_t nLive, nChunks;
+  static T* slots(Chunk* c) {
+    return (T*)((char*)c + slotOffset);
+  }
+  static Chunk* chunkOf(const void* p) {
+    return (Chunk*)((std::uintptr_t)p &
+      ~(std::uintptr_t)(ChunkBytes - 1));
+  }
+  Chunk* addChunk() {
+    void* mem = ::operator new(ChunkBytes,
+      std::align_val_t(ChunkBytes));
+    Chunk* c = new(mem) Chunk(perChunk);
+    if(last) last->next = c;
+    else first = c;
+    last = c;
+    nChunks++;
+    return c;
+  }
+  // Destroy the live objects in c, in address
+  // order:
+  static void destroyIn(Chunk* c) {
+    if(!std::is_trivially_destructible<T>::value)
+      for(std::size_t i = c->used.findUsed(0);
+          i < perChunk; i = c->used.findUsed(i + 1))
+        slots(c)[i].~T();
+    c->used.clear(0, perChunk);
+    c->live = c->hint = 0;
+  }
+  ObjectPool(const ObjectPool&);
+  void operator=(const ObjectPool&);
+public:
+  static constexpr std::size_t perChunk =
+    (ChunkBytes - slotOffset) / sizeof(T);
+  ObjectPool()
+    : first(0), last(0), current(0), nLive(0),
+      nChunks(0) {}
+  ~ObjectPool() {
+    destroyAll();
+    while(first) {
+      Chunk* next = first->next;
+      first->~Chunk();
+      ::operator delete(first,
+        std::align_val_t(ChunkBytes));
+      first = next;
+    }
+  }
+  // Raw storage for one T:
+  void* allocate() {
+    if(!current || current->live == perChunk) {
+      // The first Chunk with room, or a new one:
+      current = first;
+      while(current && current->live == perChunk)
+        current = current->next;
+      if(!current) current = addChunk();
+    }
+    std::size_t i =
+      current->used.findFree(current->hint);
+    current->used.set(i);
+    current->hint = i + 1;
+    current->live++;
+    nLive++;
+    return slots(current) + i;
+  }
+  void deallocate(void* p) {
+    if(!p) return;
+    Chunk* c = chunkOf(p);
+    std::size_t i = (T*)p - slots(c);
+    REQUIRE_AT(REQUIRE_CHEAP,
+      i < perChunk && c->used.test(i),
+      "ObjectPool: freeing a slot not in use");
+    c->used.clear(i);
+    c->live--;
+    nLive--;
+    // A full current Chunk: allocate here next
+    if(current->live == perChunk) current = c;
+  }
+  template<class... Args>
+  T* construct(Args&&... args) {
+    void* p = allocate();
+    try {
+      return new(p) T(std::forward<Args>(args)...);
+    } catch(...) {
+      deallocate(p);
+      throw;
+    }
+  }
+  void destroy(T* p) {
+    if(!p) return;
+    p->~T();
+    deallocate(p);
+  }
+  // Every live object, at once. The Chunks are
+  // kept for reuse:
+  void destroyAll() {
+    for(Chunk* c = first; c; c = c->next)
+      destroyIn(c);
+    nLive = 0;
+    current = first;
+  }
+  // Visit the live objects in address order,
+  // Chunk by Chunk:
+  template<class F>
+  void forEach(F f) {
+    for(Chunk* c = first; c; c = c->next)
+      for(std::size_t i = c->used.findUsed(0);
+          i < perChunk; i = c->used.findUsed(i + 1))
+        f(slots(c)[i]);
+  }
+  bool owns(const void* p) const {
+    Chunk* target = chunkOf(p);
+    for(Chunk* c = first; c; c = c->next)
+      if(c == target) {
+        std::size_t off = (const char*)p -
+          (const char*)slots(c);
+        return (const char*)p >=
+          (const char*)slots(c) &&
+          off % sizeof(T) == 0 &&
+          off / sizeof(T) < perChunk &&
+          c->used.test(off / sizeof(T));
+      }
+    return false;
+  }
+  std::size_t size() const { return nLive; }
+  std::size_t chunkCount() const { return nChunks; }
+};
+
+// Put OBJECT_POOL(ClassName) in a class body and
+// new and delete of that class use a shared
+// ObjectPool; call sites don't change. Like
+// Pooled in FixedPool.h, a derived class of
+// another size gets the global heap, and the
+// pool is never destroyed. The shared pool is
+// not thread-safe: once a class opts in, only
+// one thread at a time may new or delete it:
+#define OBJECT_POOL(T) \
+  static ObjectPool<T>& objectPool() { \
+    static ObjectPool<T>& p = \
+      *new ObjectPool<T>; \
+    return p; \
+  } \
+  static void* operator new(std::size_t sz) { \
+    return sz == sizeof(T) ? \
+      objectPool().allocate() : \
+      ::operator new(sz); \
+  } \
+  static void operator delete(void* p, \
+    std::size_t sz) { \
+    if(sz == sizeof(T)) \
+      objectPool().deallocate(p); \
+    else \
+      ::operator delete(p); \
+  }
+#endif // OBJECTPOOL_H ///:~
@@ -0,0 +1,95 @@
+//: C13:ObjectPoolBench.cpp
+// Building, walking and freeing a tree of nodes
+#include "ObjectPool.h"
+#include "../bench.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+using namespace std;
+
+struct Node {
+  Node* left;
+  Node* right;
+  long key;
+  Node(long k) : left(0), right(0), key(k) {}
+};
+
+// Unbalanced binary search tree insert:
+void insert(Node*& root, Node* n) {
+  Node** p = &root;
+  while(*p)
+    p = n->key < (*p)->key ? 
+      &(*p)->left : &(*p)->right;
+  *p = n;
+}
+long sum(Node* n) {
+  long s = 0;
+  while(n) { // Right spine iteratively
+    s += n->key + sum(n->left);
+    n = n->right;
+  }
+  return s;
+}
+void freeAll(Node* n) {
+  while(n) {
+    freeAll(n->left);
+    Node* r = n->right;
+    delete n;
+    n = r;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  long n = benchArg(argc, argv, 1, 1000000);
+  vector<long> keys(n);
+  unsigned long r = 88172645463325252UL;
+  for(auto& k : keys) {
+    r ^= r << 13; r ^= r >> 7; r ^= r << 17;
+    k = long(r % (n * 4));
+  }
+  {
+    // Other allocations in between scatter the
+    // nodes, as in a long-running program:
+    vector<string*> noise;
+    Node* root = 0;
+    Timer t;
+    for(long i = 0; i < n; i++) {
+      insert(root, new Node(keys[i]));
+      if(i % 2) noise.push_back(
+        new string(16 + i % 48, 'x'));
+    }
+    report("new: build", t.seconds(), n);
+    t.reset();
+    keep(sum(root));
+    report("new: walk", t.seconds(), n);
+    t.reset();
+    freeAll(root);
+    report("new: free one by one", t.seconds(), n);
+    for(auto s : noise) delete s;
+  }
+  {
+    ObjectPool<Node> pool;
+    vector<string*> noise;
+    Node* root = 0;
+    Timer t;
+    for(long i = 0; i < n; i++) {
+      insert(root, pool.construct(keys[i]));
+      if(i % 2) noise.push_back(
+        new string(16 + i % 48, 'x'));
+    }
+    report("ObjectPool: build", t.seconds(), n);
+    t.reset();
+    keep(sum(root));
+    report("ObjectPool: walk", t.seconds(), n);
+    t.reset();
+    long s = 0;
+    pool.forEach([&s](Node& x) { s += x.key; });
+    keep(s);
+    report("ObjectPool: forEach", t.seconds(), n);
+    t.reset();
+    pool.destroyAll();
+    report("ObjectPool: destroyAll", 
+      t.seconds(), n);
+    for(auto s : noise) delete s;
+  }
+} ///:~
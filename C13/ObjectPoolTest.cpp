@@ -0,0 +1,93 @@
+//: C13:ObjectPoolTest.cpp
+// Order, reuse, destroyAll and OBJECT_POOL
+#include "ObjectPool.h"
+#include "Tree.h"
+#include "../require.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+int alive = 0;
+
+struct Node {
+  Node* left;
+  Node* right;
+  long key;
+  Node(long k) : left(0), right(0), key(k) {
+    alive++;
+  }
+  ~Node() { alive--; }
+};
+
+class Named {
+  string nm;
+public:
+  OBJECT_POOL(Named)
+  Named(const string& s) : nm(s) {}
+  virtual ~Named() {}
+  const string& name() const { return nm; }
+};
+
+// Larger, so it bypasses Named's pool:
+class Tagged : public Named {
+  char tag[64];
+public:
+  Tagged() : Named("tagged") { tag[0] = 0; }
+};
+
+int main() {
+  typedef ObjectPool<Node, 4096> Pool;
+  Pool pool;
+  // Exactly four full Chunks:
+  const long count = 4 * Pool::perChunk;
+  vector<Node*> v;
+  for(long i = 0; i < count; i++)
+    v.push_back(pool.construct(i));
+  require(alive == count && pool.size() == count);
+  require(pool.chunkCount() == 4);
+  // Allocation order is address order within
+  // a Chunk:
+  for(int i = 1; i < 20; i++)
+    require(v[i] == v[i - 1] + 1, "Not adjacent");
+  long expect = 0;
+  pool.forEach([&](Node& n) {
+    require(n.key == expect++, "Out of order");
+  });
+  // With every Chunk full, a destroyed slot
+  // is the next one reused:
+  Node* gone = v[500];
+  pool.destroy(gone);
+  require(!pool.owns(gone));
+  v[500] = pool.construct(-1);
+  require(v[500] == gone, "Slot not reused");
+  require(pool.owns(v[500]));
+  int dummy = 0;
+  require(!pool.owns(&dummy));
+  // destroyAll runs every destructor:
+  pool.destroyAll();
+  require(alive == 0 && pool.size() == 0);
+  size_t chunks = pool.chunkCount();
+  for(long i = 0; i < count; i++)
+    pool.construct(i);
+  require(pool.chunkCount() == chunks,
+    "Chunks not reused");
+  // The macro makes plain new/delete use it:
+  Named* n = new Named("rex");
+  require(Named::objectPool().owns(n));
+  Named* t = new Tagged;
+  require(!Named::objectPool().owns(t));
+  require(Named::objectPool().size() == 1);
+  delete t;
+  delete n;
+  require(Named::objectPool().size() == 0);
+  // Tree opts in the same way:
+  ostringstream os;
+  Tree* tree = new Tree(40);
+  require(Tree::objectPool().size() == 1);
+  os << tree;
+  delete tree;
+  require(Tree::objectPool().size() == 0);
+  cout << endl << "ObjectPool OK" << endl;
+} ///:~
@@ -0,0 +1,352 @@
+//: C13:SizeClassNew.cpp {O}
+// Global operator new with power-of-two classes
+// Link this into any program to replace the
+// global operator new and delete. Requests up
+// to 16K are rounded up to a power of two and
+// served from 64K slabs, through a per-thread
+// cache of free blocks; larger ones get their
+// own mapping. POSIX only (mmap).
+#include "SizeClassNew.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <sys/mman.h>
+using namespace std;
+
+namespace {
+const size_t slabSize = 64 * 1024;
+const size_t headerSize = 64; // Keeps blocks
+                              // cache-aligned
+const size_t minShift = 4;    // 16 bytes
+const size_t maxSmall = size_t(1) <<
+  (minShift + sizeClassCount - 1);
+const uint32_t slabMagic = 0x5C1A55ED;
+const int largeClass = -1;
+
+// Every slab and large mapping is 64K-aligned
+// and starts with one of these, so delete finds
+// it by masking the pointer:
+struct SlabHeader {
+  uint32_t magic;
+  int32_t cls;
+  size_t length; // Of the mapping
+};
+
+struct FreeBlock { FreeBlock* next; };
+
+// The shared state for one class. Everything
+// here is constant-initialized, so operator new
+// works before any constructor has run:
+struct Central {
+  mutex lock;
+  FreeBlock* freeList = 0;
+  char* carve = 0;    // Unused part of the
+  char* carveEnd = 0; // newest slab
+  unsigned long allocs = 0, frees = 0, slabs = 0;
+};
+Central central[sizeClassCount];
+atomic<unsigned long> largeAllocs(0),
+  largeFrees(0), largeMaps(0);
+atomic<size_t> largeBytes(0);
+
+struct ClassCache {
+  FreeBlock* head;
+  unsigned n;
+  unsigned long allocs, frees;
+};
+// Plain data, so a thread's first use needs
+// no guard. dead is set once the thread's
+// destructors have run; later calls bypass
+// the cache:
+struct ThreadCache {
+  ClassCache c[sizeClassCount];
+  bool dead;
+};
+thread_local ThreadCache cache;
+
+inline size_t blockSize(int cls) {
+  return size_t(1) << (cls + minShift);
+}
+inline int sizeClass(size_t sz) {
+  if(sz <= (size_t(1) << minShift)) return 0;
+  return 64 - __builtin_clzll(sz - 1) - minShift;
+}
+// Blocks moved between a thread and the
+// central list at once; fewer for big blocks:
+inline unsigned batch(int cls) {
+  size_t n = 8192 / blockSize(cls);
+  return n < 4 ? 4 : n > 64 ? 64 : unsigned(n);
+}
+
+void* mapAligned(size_t length) {
+  // Over-map, then trim to 64K alignment:
+  size_t extra = length + slabSize;
+  char* p = (char*)mmap(0, extra,
+    PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(p == MAP_FAILED) return 0;
+  char* base = (char*)(((uintptr_t)p +
+    slabSize - 1) & ~(uintptr_t)(slabSize - 1));
+  if(base > p) munmap(p, base - p);
+  char* end = p + extra;
+  if(end > base + length)
+    munmap(base + length, end - (base + length));
+  return base;
+}
+
+inline SlabHeader* headerOf(void* p) {
+  return (SlabHeader*)((uintptr_t)p &
+    ~(uintptr_t)(slabSize - 1));
+}
+
+// Called with c.lock held:
+FreeBlock* carveBlock(Central& c, int cls) {
+  size_t bs = blockSize(cls);
+  if(c.carve + bs > c.carveEnd) {
+    SlabHeader* h = (SlabHeader*)
+      mapAligned(slabSize);
+    if(!h) return 0;
+    h->magic = slabMagic;
+    h->cls = cls;
+    h->length = slabSize;
+    c.slabs++;
+    c.carve = (char*)h + headerSize;
+    c.carveEnd = (char*)h + slabSize;
+  }
+  FreeBlock* b = (FreeBlock*)c.carve;
+  c.carve += bs;
+  return b;
+}
+
+// Move the thread's counts into the central
+// totals; called with c.lock held:
+void foldCounts(Central& c, ClassCache& cc) {
+  c.allocs += cc.allocs;
+  c.frees += cc.frees;
+  cc.allocs = cc.frees = 0;
+}
+
+void* allocateCentral(int cls) {
+  Central& c = central[cls];
+  lock_guard<mutex> g(c.lock);
+  c.allocs++;
+  FreeBlock* b = c.freeList;
+  if(b) c.freeList = b->next;
+  else b = carveBlock(c, cls);
+  return b;
+}
+
+void freeCentral(int cls, FreeBlock* b) {
+  Central& c = central[cls];
+  lock_guard<mutex> g(c.lock);
+  c.frees++;
+  b->next = c.freeList;
+  c.freeList = b;
+}
+
+void flushThread();
+// Returns the thread's blocks to the central
+// lists when the thread exits:
+struct CacheFlusher {
+  ~CacheFlusher() {
+    flushThread();
+    cache.dead = true;
+  }
+};
+thread_local CacheFlusher flusher;
+
+// The slow path of allocate: take a batch from
+// the central list, return one of them:
+void* refill(int cls) {
+  (void)&flusher; // Registers its destructor
+  ClassCache& cc = cache.c[cls];
+  Central& c = central[cls];
+  lock_guard<mutex> g(c.lock);
+  foldCounts(c, cc);
+  c.allocs++;
+  FreeBlock* result = 0;
+  for(unsigned i = 0; i < batch(cls); i++) {
+    FreeBlock* b = c.freeList;
+    if(b) c.freeList = b->next;
+    else if(!(b = carveBlock(c, cls))) break;
+    if(!result) { result = b; continue; }
+    b->next = cc.head;
+    cc.head = b;
+    cc.n++;
+  }
+  return result;
+}
+
+// The slow path of free: a cache holding two
+// batches gives one back:
+void release(int cls) {
+  ClassCache& cc = cache.c[cls];
+  Central& c = central[cls];
+  lock_guard<mutex> g(c.lock);
+  foldCounts(c, cc);
+  for(unsigned i = batch(cls); i > 0; i--) {
+    FreeBlock* b = cc.head;
+    cc.head = b->next;
+    cc.n--;
+    b->next = c.freeList;
+    c.freeList = b;
+  }
+}
+
+void flushThread() {
+  for(int cls = 0; cls < sizeClassCount; cls++) {
+    ClassCache& cc = cache.c[cls];
+    Central& c = central[cls];
+    lock_guard<mutex> g(c.lock);
+    foldCounts(c, cc);
+    while(cc.head) {
+      FreeBlock* b = cc.head;
+      cc.head = b->next;
+      b->next = c.freeList;
+      c.freeList = b;
+    }
+    cc.n = 0;
+  }
+}
+
+void* allocateLarge(size_t sz) {
+  // Leave room for the rounding here and the
+  // over-map in mapAligned(), or they wrap:
+  if(sz > size_t(-1) - headerSize - 4095 -
+     slabSize) return 0;
+  size_t length = (sz + headerSize + 4095) &
+    ~size_t(4095);
+  SlabHeader* h = (SlabHeader*)mapAligned(length);
+  if(!h) return 0;
+  h->magic = slabMagic;
+  h->cls = largeClass;
+  h->length = length;
+  largeAllocs++;
+  largeMaps++;
+  largeBytes += length;
+  return (char*)h + headerSize;
+}
+
+inline void* allocate(size_t sz) {
+  if(sz <= maxSmall) {
+    int cls = sizeClass(sz);
+    if(cache.dead) return allocateCentral(cls);
+    ClassCache& cc = cache.c[cls];
+    if(FreeBlock* b = cc.head) {
+      cc.head = b->next;
+      cc.n--;
+      cc.allocs++;
+      return b;
+    }
+    return refill(cls);
+  }
+  return allocateLarge(sz);
+}
+
+// As the standard requires: on failure, call
+// the new_handler and try again:
+void* allocateOrThrow(size_t sz) {
+  for(;;) {
+    if(void* p = allocate(sz)) return p;
+    new_handler h = get_new_handler();
+    if(!h) throw bad_alloc();
+    h();
+  }
+}
+
+void deallocate(void* p) {
+  if(!p) return;
+  SlabHeader* h = headerOf(p);
+  if(h->cls == largeClass) {
+    largeFrees++;
+    largeBytes -= h->length;
+    munmap(h, h->length);
+    return;
+  }
+  int cls = h->cls;
+  FreeBlock* b = (FreeBlock*)p;
+  if(cache.dead) return freeCentral(cls, b);
+  ClassCache& cc = cache.c[cls];
+  b->next = cc.head;
+  cc.head = b;
+  cc.frees++;
+  if(++cc.n >= 2 * batch(cls)) release(cls);
+}
+} // namespace
+
+void* operator new(size_t sz) {
+  return allocateOrThrow(sz);
+}
+void* operator new[](size_t sz) {
+  return allocateOrThrow(sz);
+}
+void* operator new(size_t sz,
+  const nothrow_t&) noexcept {
+  try { return allocateOrThrow(sz); }
+  catch(...) { return 0; }
+}
+void* operator new[](size_t sz,
+  const nothrow_t&) noexcept {
+  try { return allocateOrThrow(sz); }
+  catch(...) { return 0; }
+}
+void operator delete(void* p) noexcept {
+  deallocate(p);
+}
+void operator delete[](void* p) noexcept {
+  deallocate(p);
+}
+void operator delete(void* p, size_t) noexcept {
+  deallocate(p);
+}
+void operator delete[](void* p,
+  size_t) noexcept {
+  deallocate(p);
+}
+void operator delete(void* p,
+  const nothrow_t&) noexcept {
+  deallocate(p);
+}
+void operator delete[](void* p,
+  const nothrow_t&) noexcept {
+  deallocate(p);
+}
+
+SizeClassStats sizeClassStats(int cls) {
+  SizeClassStats s = { 0, 0, 0, 0, 0 };
+  if(cls == sizeClassCount) {
+    s.allocs = largeAllocs;
+    s.frees = largeFrees;
+    s.slabs = largeMaps - largeFrees;
+    s.bytes = largeBytes;
+  } else if(cls >= 0 && cls < sizeClassCount) {
+    Central& c = central[cls];
+    lock_guard<mutex> g(c.lock);
+    s.blockSize = blockSize(cls);
+    s.allocs = c.allocs;
+    s.frees = c.frees;
+    s.slabs = c.slabs;
+    s.bytes = c.slabs * slabSize;
+  }
+  return s;
+}
+
+void sizeClassFlush() {
+  if(!cache.dead) flushThread();
+}
+
+void sizeClassReport(FILE* out) {
+  fprintf(out, "%8s %12s %12s %8s %10s\n", "size",
+    "allocs", "frees", "slabs", "KB");
+  for(int cls = 0; cls <= sizeClassCount; cls++) {
+    SizeClassStats s = sizeClassStats(cls);
+    if(!s.allocs) continue;
+    if(s.blockSize)
+      fprintf(out, "%8zu", s.blockSize);
+    else
+      fprintf(out, "%8s", "large");
+    fprintf(out, " %12lu %12lu %8lu %10zu\n",
+      s.allocs, s.frees, s.slabs, s.bytes / 1024);
+  }
+} ///:~
@@ -0,0 +1,26 @@
+//: C13:SizeClassNew.h
+// Statistics from the size-class operator new
+#ifndef SIZECLASSNEW_H
+#define SIZECLASSNEW_H
+#include <cstddef>
+#include <cstdio>
+
+// Classes 0 .. sizeClassCount - 1 hold blocks of
+// 16, 32, ... bytes; row sizeClassCount counts
+// the large requests sent to mmap:
+const int sizeClassCount = 11;
+
+struct SizeClassStats {
+  std::size_t blockSize; // 0 for the large row
+  unsigned long allocs, frees;
+  unsigned long slabs; // 64K slabs (or mappings)
+  std::size_t bytes;   // Reserved from the system
+};
+
+// Counts kept in a thread's cache are added
+// when it trades blocks with the central lists,
+// exits, or calls sizeClassFlush():
+SizeClassStats sizeClassStats(int cls);
+void sizeClassFlush();
+void sizeClassReport(std::FILE* out = stderr);
+#endif // SIZECLASSNEW_H ///:~
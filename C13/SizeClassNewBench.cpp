@@ -0,0 +1,51 @@
+//: C13:SizeClassNewBench.cpp
+//{L} SizeClassNew
+// Small-object churn: size classes vs. malloc
+#include "SizeClassNew.h"
+#include "../bench.h"
+#include <cstdlib>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Sizes up to maxSize, with a working set of
+// live objects, freed in random order:
+template<class Alloc, class Free>
+double churn(long ops, size_t live,
+  size_t maxSize, Alloc alloc, Free release) {
+  vector<void*> v(live);
+  unsigned r = 12345;
+  for(auto& p : v) {
+    r = r * 1103515245 + 12345;
+    p = alloc(8 + (r >> 8) % maxSize);
+  }
+  Timer t;
+  for(long i = 0; i < ops; i++) {
+    r = r * 1103515245 + 12345;
+    void*& p = v[(r >> 8) % live];
+    release(p);
+    p = alloc(8 + (r >> 16) % maxSize);
+  }
+  double secs = t.seconds();
+  for(auto p : v) release(p);
+  return secs;
+}
+
+int main(int argc, char* argv[]) {
+  long ops = benchArg(argc, argv, 1, 5000000);
+  size_t maxSizes[] = { 64, 256, 1024 };
+  for(size_t m : maxSizes) {
+    size_t live = 10000;
+    printf("sizes 8..%zu, %zu live:\n",
+      m + 8, live);
+    report("  malloc/free", churn(ops, live, m,
+      [](size_t n) { return malloc(n); },
+      [](void* p) { free(p); }), ops);
+    report("  size-class new/delete", 
+      churn(ops, live, m,
+      [](size_t n) { return ::operator new(n); },
+      [](void* p) { ::operator delete(p); }), ops);
+  }
+  sizeClassFlush();
+  sizeClassReport(stdout);
+} ///:~
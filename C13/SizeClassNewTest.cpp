@@ -0,0 +1,84 @@
+//: C13:SizeClassNewTest.cpp
+//{L} SizeClassNew
+// Sizes, alignment, large blocks and threads
+#include "SizeClassNew.h"
+#include "../require.h"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+int main() {
+  // Every size gets usable, aligned memory
+  // that doesn't overlap its neighbors:
+  vector<pair<char*, size_t> > blocks;
+  for(size_t sz = 0; sz < 70000; 
+      sz += sz < 64 ? 1 : sz / 3) {
+    char* p = new char[sz];
+    require((uintptr_t)p % 16 == 0, "Misaligned");
+    memset(p, int(sz & 0xFF), sz);
+    blocks.push_back(make_pair(p, sz));
+  }
+  for(auto& b : blocks) {
+    for(size_t i = 0; i < b.second; i++)
+      require(b.first[i] == char(b.second & 0xFF),
+        "Block overwritten");
+    delete []b.first;
+  }
+  // Freed blocks are reused:
+  int* a = new int(1);
+  delete a;
+  int* b = new int(2);
+  require(a == b, "Block not reused");
+  delete b;
+  // Large requests map and unmap:
+  SizeClassStats before = 
+    sizeClassStats(sizeClassCount);
+  {
+    unique_ptr<char[]> big(new char[1 << 20]);
+    big[(1 << 20) - 1] = 1;
+    require(sizeClassStats(sizeClassCount)
+      .bytes > before.bytes);
+  }
+  require(sizeClassStats(sizeClassCount).bytes
+    == before.bytes, "Large block not unmapped");
+  // Allocate on one thread, free on another;
+  // library types use it too:
+  vector<string*> strs;
+  thread([&] {
+    for(int i = 0; i < 10000; i++)
+      strs.push_back(new string(
+        string(i % 100, 'x') + to_string(i)));
+  }).join();
+  thread([&] {
+    for(int i = 0; i < 10000; i++) {
+      require(strs[i]->size() > 0);
+      delete strs[i];
+    }
+  }).join();
+  sizeClassFlush();
+  SizeClassStats s32 = sizeClassStats(1);
+  require(s32.blockSize == 32 && s32.allocs > 0);
+  require(s32.allocs >= s32.frees);
+  bool threw = false;
+  try {
+    ::operator delete(
+      ::operator new(size_t(-1) / 4));
+  } catch(bad_alloc&) {
+    threw = true;
+  }
+  require(threw, "Huge request should throw");
+  // Near SIZE_MAX, where the rounding wraps:
+  volatile size_t nearMax = size_t(-1) - 40000;
+  threw = false;
+  try {
+    ::operator delete(::operator new(nearMax));
+  } catch(bad_alloc&) {
+    threw = true;
+  }
+  require(threw, "Wrapping request should throw");
+  sizeClassReport(stdout);
+} ///:~
@@ -5,11 +5,13 @@
 // Copyright notice in Copyright.txt
 #ifndef TREE_H
 #define TREE_H
+#include "ObjectPool.h"
 #include <iostream>
 
 class Tree {
   int height;
 public:
+  OBJECT_POOL(Tree) // new and delete use a pool
   Tree(int treeHeight) : height(treeHeight) {}
   ~Tree() { std::cout << "*"; }
   friend std::ostream&
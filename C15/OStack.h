@@ -6,6 +6,9 @@
 // Using a singly-rooted hierarchy
 #ifndef OSTACK_H
 #define OSTACK_H
+#include "../C13/Arena.h"
+#include <new>
+#include <utility>
 
 class Object {
 public:
@@ -19,17 +22,47 @@ class Stack {
   struct Link {
     Object* data;
     Link* next;
-    Link(Object* dat, Link* nxt) : 
-      data(dat), next(nxt) {}
+    bool inArena; // data made by create()
+    Link(Object* dat, Link* nxt, bool a = false)
+      : data(dat), next(nxt), inArena(a) {}
   }* head;
+  Arena* arena; // Non-zero in arena mode
+  void link(Object* dat, bool inArena) {
+    head = arena ? new(arena->allocate(
+      sizeof(Link), alignof(Link)))
+      Link(dat, head, inArena)
+      : new Link(dat, head);
+  }
 public:
-  Stack() : head(0) {}
+  Stack() : head(0), arena(0) {}
+  // Arena mode: Links and the objects made with
+  // create() live in a, and are freed when a is.
+  // Objects push()ed from the heap are still
+  // deleted as usual. Don't delete what pop()
+  // returns if create() made it:
+  explicit Stack(Arena& a) : head(0), arena(&a) {}
   ~Stack(){ 
+    if(arena) {
+      // Run the virtual destructors, but leave
+      // the storage for the Arena to free:
+      for(Link* p = head; p; p = p->next)
+        if(p->inArena) p->data->~Object();
+        else delete p->data;
+      return;
+    }
     while(head)
       delete pop();
   }
-  void push(Object* dat) {
-    head = new Link(dat, head);
+  void push(Object* dat) { link(dat, false); }
+  // Construct a derived object in the Arena:
+  template<class O, class... Args>
+  O* create(Args&&... args) {
+    require(arena != 0, 
+      "Stack::create() needs an Arena");
+    O* p = new(arena->allocate(sizeof(O),
+      alignof(O))) O(std::forward<Args>(args)...);
+    link(p, true);
+    return p;
   }
   Object* peek() const { 
     return head ? head->data : 0;
@@ -39,7 +72,7 @@ public:
     Object* result = head->data;
     Link* oldHead = head;
     head = head->next;
-    delete oldHead;
+    if(!arena) delete oldHead;
     return result;
   }
 };
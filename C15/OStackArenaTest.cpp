@@ -0,0 +1,52 @@
+//: C15:OStackArenaTest.cpp
+// OStack in arena mode: one bulk free
+#include "OStack.h"
+#include "../require.h"
+#include "../bench.h"
+#include <iostream>
+#include <string>
+using namespace std;
+
+class MyString: public string, public Object {
+public:
+  static long live;
+  MyString(string s) : string(s) { live++; }
+  ~MyString() { live--; }
+};
+long MyString::live = 0;
+
+int main(int argc, char* argv[]) {
+  long n = benchArg(argc, argv, 1, 1000000);
+  require(n > 0, "Count must be positive");
+  double heap, arena;
+  {
+    Stack* s = new Stack;
+    for(long i = 0; i < n; i++)
+      s->push(new MyString("line"));
+    Timer t;
+    delete s;
+    heap = t.seconds();
+  }
+  require(MyString::live == 0, "Heap leak");
+  {
+    Arena a(1 << 20);
+    Stack* s = new Stack(a);
+    for(long i = 0; i < n; i++)
+      s->create<MyString>("line");
+    // Popped objects still belong to the Arena:
+    MyString* top = (MyString*)s->pop();
+    cout << "popped: " << *top << endl;
+    top->~MyString();
+    // A heap object is deleted, not just
+    // destroyed, at teardown:
+    s->push(new MyString("heap"));
+    Timer t;
+    delete s; // Virtual destructors only
+    a.release(); // Every Block in one pass
+    arena = t.seconds();
+  }
+  require(MyString::live == 0, 
+    "Arena mode skipped a destructor");
+  report("heap OStack teardown", heap, n);
+  report("arena OStack teardown", arena, n);
+} ///:~
@@ -0,0 +1,62 @@
+//: C16:ArenaTeardownBench.cpp
+// Destroying an OwnerStack: heap vs. Arena
+#include "OwnerStack.h"
+#include "../bench.h"
+#include <iostream>
+using namespace std;
+
+struct Point { // Trivially destructible
+  double x, y;
+  Point(double xx = 0, double yy = 0) 
+    : x(xx), y(yy) {}
+};
+
+class Base {
+public:
+  virtual ~Base() {}
+};
+
+class Derived : public Base {
+  long v;
+public:
+  static long destroyed;
+  Derived(long vv = 0) : v(vv) {}
+  ~Derived() { destroyed += v & 1; }
+};
+long Derived::destroyed = 0;
+
+template<class T>
+double heapTeardown(long n) {
+  Stack<T>* s = new Stack<T>;
+  for(long i = 0; i < n; i++)
+    s->push(new T(i));
+  Timer t;
+  delete s; // A free() per Link and per element
+  return t.seconds();
+}
+
+template<class T>
+double arenaTeardown(long n) {
+  Arena* a = new Arena(1 << 20);
+  Stack<T>* s = new Stack<T>(*a);
+  for(long i = 0; i < n; i++)
+    s->create(i);
+  Timer t;
+  delete s;
+  delete a; // Frees all Blocks in one pass
+  return t.seconds();
+}
+
+int main(int argc, char* argv[]) {
+  long n = benchArg(argc, argv, 1, 2000000);
+  cout << n << " elements" << endl;
+  report("heap, trivial T", 
+    heapTeardown<Point>(n), n);
+  report("arena, trivial T", 
+    arenaTeardown<Point>(n), n);
+  report("heap, virtual ~T", 
+    heapTeardown<Derived>(n), n);
+  report("arena, virtual ~T", 
+    arenaTeardown<Derived>(n), n);
+  keep(Derived::destroyed);
+} ///:~
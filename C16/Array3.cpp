@@ -5,15 +5,17 @@
 // Copyright notice in Copyright.txt
 // Built-in types as template arguments
 #include "../require.h"
+#include "BoundsCheck.h"
 #include <iostream>
 using namespace std;
 
-template<class T, int size = 100>
+template<class T, int size = 100, 
+  class Bounds = DefaultBounds>
 class Array {
   T array[size];
 public:
   T& operator[](int index) {
-    require(index >= 0 && index < size,
+    Bounds::check(index >= 0 && index < size,
       "Index out of range");
     return array[index];
   }
@@ -5,6 +5,11 @@
 // Copyright notice in Copyright.txt
 // Definition of static class members
 #include "AutoCounter.h"
-AutoCounter::CleanupCheck AutoCounter::verifier;
-int AutoCounter::count = 0;
+std::atomic<int> AutoCounter::count(0);
+// As CleanupCheck did, a leak or a double
+// delete fails the program. Set
+// LEAKTRACKER_LOG to see every create and
+// destroy:
+static const bool autoCounterStrict = 
+  (AutoCounter::tracker().failing(true), true);
 ///:~
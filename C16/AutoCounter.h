@@ -5,35 +5,23 @@
 // Copyright notice in Copyright.txt
 #ifndef AUTOCOUNTER_H
 #define AUTOCOUNTER_H
-#include "../require.h"
+#include "LeakTracker.h"
+#include <atomic>
 #include <iostream>
-#include <set> // Standard C++ Library container
 #include <string>
 
-class AutoCounter {
-  static int count;
+// Counted by a strict LeakTracker (see
+// AutoCounter.cpp), which fails the program
+// on a leak or double delete. The trace below
+// is printed only while its logging is on:
+class AutoCounter 
+  : public LeakTracked<AutoCounter> {
+  static std::atomic<int> count;
   int id;
-  class CleanupCheck {
-    std::set<AutoCounter*> trace;
-  public:
-    void add(AutoCounter* ap) {
-      trace.insert(ap);
-    }
-    void remove(AutoCounter* ap) {
-      require(trace.erase(ap) == 1,
-        "Attempt to delete AutoCounter twice");
-    }
-    ~CleanupCheck() {
-      std::cout << "~CleanupCheck()"<< std::endl;
-      require(trace.size() == 0,
-       "All AutoCounter objects not cleaned up");
-    }
-  };
-  static CleanupCheck verifier;
   AutoCounter() : id(count++) {
-    verifier.add(this); // Register itself
-    std::cout << "created[" << id << "]" 
-              << std::endl;
+    if(tracker().logging())
+      std::cout << "created[" << id << "]" 
+                << std::endl;
   }
   // Prevent assignment and copy-construction:
   AutoCounter(const AutoCounter&);
@@ -44,9 +32,9 @@ public:
     return new AutoCounter();
   }
   ~AutoCounter() {
-    std::cout << "destroying[" << id 
-              << "]" << std::endl;
-    verifier.remove(this);
+    if(tracker().logging())
+      std::cout << "destroying[" << id 
+                << "]" << std::endl;
   }
   // Print both objects and pointers:
   friend std::ostream& operator<<(
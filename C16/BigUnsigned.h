@@ -0,0 +1,194 @@
+//: C16:BigUnsigned.h
+// Arbitrary-precision unsigned integer
+#ifndef BIGUNSIGNED_H
+#define BIGUNSIGNED_H
+#include "../require.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class BigUnsigned {
+  typedef std::uint32_t Limb;
+  typedef std::uint64_t Wide;
+  typedef std::vector<Limb> Limbs;
+  Limbs d; // Little-endian, no leading zeros
+  // Below this many limbs, schoolbook
+  // multiplication beats Karatsuba:
+  enum { karatsubaCutoff = 48 };
+  static void trim(Limbs& v) {
+    while(!v.empty() && v.back() == 0)
+      v.pop_back();
+  }
+  static Limbs add(const Limbs& a,
+    const Limbs& b) {
+    bool aShort = a.size() < b.size();
+    const Limbs& lo = aShort ? a : b;
+    const Limbs& hi = aShort ? b : a;
+    Limbs r(hi.size() + 1);
+    Wide carry = 0;
+    for(std::size_t i = 0; i < hi.size(); i++) {
+      carry += Wide(hi[i]) + 
+        (i < lo.size() ? lo[i] : 0);
+      r[i] = Limb(carry);
+      carry >>= 32;
+    }
+    r[hi.size()] = Limb(carry);
+    trim(r);
+    return r;
+  }
+  // a -= b, where a >= b:
+  static void subInPlace(Limbs& a,
+    const Limbs& b) {
+    std::int64_t borrow = 0;
+    for(std::size_t i = 0; i < a.size(); i++) {
+      std::int64_t x = std::int64_t(a[i])
+        - borrow - (i < b.size() ? b[i] : 0);
+      borrow = x < 0;
+      a[i] = Limb(x + (borrow << 32));
+      if(i >= b.size() && !borrow) break;
+    }
+    require(borrow == 0, 
+      "BigUnsigned: subtraction underflow");
+    trim(a);
+  }
+  // r += x << (32 * shift):
+  static void addShifted(Limbs& r,
+    const Limbs& x, std::size_t shift) {
+    if(r.size() < x.size() + shift + 1)
+      r.resize(x.size() + shift + 1);
+    Wide carry = 0;
+    std::size_t i = 0;
+    for(; i < x.size(); i++) {
+      carry += Wide(r[i + shift]) + x[i];
+      r[i + shift] = Limb(carry);
+      carry >>= 32;
+    }
+    for(i += shift; carry; i++) {
+      if(i == r.size()) r.push_back(0);
+      carry += r[i];
+      r[i] = Limb(carry);
+      carry >>= 32;
+    }
+  }
+  static Limbs schoolbook(const Limbs& a, 
+    const Limbs& b) {
+    Limbs r(a.size() + b.size());
+    for(std::size_t i = 0; i < a.size(); i++) {
+      Wide carry = 0;
+      for(std::size_t j = 0; j < b.size(); j++) {
+        carry += Wide(a[i]) * b[j] + r[i + j];
+        r[i + j] = Limb(carry);
+        carry >>= 32;
+      }
+      r[i + b.size()] = Limb(carry);
+    }
+    trim(r);
+    return r;
+  }
+  static Limbs part(const Limbs& v, 
+    std::size_t from, std::size_t to) {
+    from = std::min(from, v.size());
+    to = std::min(to, v.size());
+    Limbs r(v.begin() + from, v.begin() + to);
+    trim(r);
+    return r;
+  }
+  static Limbs multiply(const Limbs& a, 
+    const Limbs& b) {
+    if(a.empty() || b.empty()) return Limbs();
+    if(std::min(a.size(), b.size()) < 
+       std::size_t(karatsubaCutoff))
+      return schoolbook(a, b);
+    // Karatsuba: three half-size products
+    // instead of four:
+    std::size_t m =
+      std::max(a.size(), b.size()) / 2;
+    Limbs a0 = part(a, 0, m),
+      a1 = part(a, m, a.size());
+    Limbs b0 = part(b, 0, m),
+      b1 = part(b, m, b.size());
+    Limbs z0 = multiply(a0, b0);
+    Limbs z2 = multiply(a1, b1);
+    Limbs z1 =
+      multiply(add(a0, a1), add(b0, b1));
+    subInPlace(z1, z0);
+    subInPlace(z1, z2);
+    Limbs r(z0);
+    addShifted(r, z1, m);
+    addShifted(r, z2, 2 * m);
+    trim(r);
+    return r;
+  }
+  explicit BigUnsigned(const Limbs& v) : d(v) {}
+public:
+  BigUnsigned(std::uint64_t v = 0) {
+    while(v) {
+      d.push_back(Limb(v));
+      v >>= 32;
+    }
+  }
+  bool isZero() const { return d.empty(); }
+  std::size_t limbs() const { return d.size(); }
+  std::uint64_t low64() const {
+    std::uint64_t r = d.empty() ? 0 : d[0];
+    if(d.size() > 1)
+      r |= std::uint64_t(d[1]) << 32;
+    return r;
+  }
+  friend BigUnsigned operator+(
+    const BigUnsigned& a, const BigUnsigned& b) {
+    return BigUnsigned(add(a.d, b.d));
+  }
+  // Requires a >= b:
+  friend BigUnsigned operator-(
+    const BigUnsigned& a, const BigUnsigned& b) {
+    BigUnsigned r(a);
+    subInPlace(r.d, b.d);
+    return r;
+  }
+  friend BigUnsigned operator*(
+    const BigUnsigned& a, const BigUnsigned& b) {
+    return BigUnsigned(multiply(a.d, b.d));
+  }
+  BigUnsigned twice() const {
+    return *this + *this;
+  }
+  friend bool operator==(
+    const BigUnsigned& a, const BigUnsigned& b) {
+    return a.d == b.d;
+  }
+  friend bool operator!=(
+    const BigUnsigned& a, const BigUnsigned& b) {
+    return a.d != b.d;
+  }
+  // Decimal digits. Quadratic, so keep it out
+  // of timed loops for very large values:
+  std::string toString() const {
+    if(d.empty()) return "0";
+    Limbs v(d);
+    std::vector<Limb> chunks; // Base 10^9
+    while(!v.empty()) {
+      Wide rem = 0;
+      for(std::size_t i = v.size(); i-- > 0; ) {
+        Wide cur = (rem << 32) | v[i];
+        v[i] = Limb(cur / 1000000000);
+        rem = cur % 1000000000;
+      }
+      chunks.push_back(Limb(rem));
+      trim(v);
+    }
+    std::string s =
+      std::to_string(chunks.back());
+    for(std::size_t i = chunks.size() - 1;
+        i-- > 0;) {
+      std::string part =
+        std::to_string(chunks[i]);
+      s += std::string(9 - part.size(), '0')
+        + part;
+    }
+    return s;
+  }
+};
+#endif // BIGUNSIGNED_H ///:~
@@ -0,0 +1,29 @@
+//: C16:BoundsCheck.h
+// Bounds-check policies for container templates
+#ifndef BOUNDSCHECK_H
+#define BOUNDSCHECK_H
+#include "../require.h"
+
+// The message stays a plain char pointer and is
+// only turned into a string when a check fails:
+struct Checked {
+  static void check(bool ok, const char* msg) {
+    if(!REQUIRE_LIKELY(ok)) requireFailed(msg);
+  }
+};
+
+// Checks vanish entirely:
+struct Unchecked {
+  static void check(bool, const char*) {}
+};
+
+// Build mode default: checked in debug builds,
+// unchecked when NDEBUG is defined or per-access
+// requires are compiled out. A container can
+// still name its policy explicitly:
+#if defined(NDEBUG) || REQUIRE_LEVEL < REQUIRE_HOT
+typedef Unchecked DefaultBounds;
+#else
+typedef Checked DefaultBounds;
+#endif
+#endif // BOUNDSCHECK_H ///:~
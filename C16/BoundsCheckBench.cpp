@@ -0,0 +1,72 @@
+//: C16:BoundsCheckBench.cpp
+// Per-access cost of bounds checks
+#include "TPStash2.h"
+#include "IterStackTemplate.h"
+#include "../bench.h"
+#include <cstdio>
+#include <string>
+using namespace std;
+
+// require() as it was, before the char*
+// overload: a std::string is built from the
+// message on every call, even on success:
+inline void oldRequire(bool requirement,
+  const string& msg = "Requirement failed") {
+  if(!requirement) requireFailed(msg.c_str());
+}
+
+struct RequireEveryCall {
+  static void check(bool ok, const char* msg) {
+    oldRequire(ok, msg);
+  }
+};
+
+const int sz = 10000;
+
+template<class Bounds>
+void pstashAccess(const char* name, int reps) {
+  PStash<int, 1024, NoStats, Bounds> ps;
+  for(int i = 0; i < sz; i++)
+    ps.add(new int(i));
+  Timer t;
+  long sum = 0;
+  for(int r = 0; r < reps; r++)
+    for(int i = 0; i < sz; i++)
+      sum += *ps[i];
+  report(name, t.seconds(), long(reps) * sz);
+  keep(sum);
+}
+
+template<class Bounds>
+void stackPushPop(const char* name, int reps) {
+  StackTemplate<long, sz, Bounds> st;
+  Timer t;
+  long sum = 0;
+  for(int r = 0; r < reps; r++) {
+    for(int i = 0; i < sz; i++)
+      st.push(i);
+    for(typename StackTemplate<long, sz, 
+        Bounds>::iterator it = st.begin();
+        it != st.end(); ++it)
+      sum += *it;
+    for(int i = 0; i < sz; i++)
+      sum += st.pop();
+  }
+  report(name, t.seconds(), 3L * reps * sz);
+  keep(sum);
+}
+
+int main(int argc, char* argv[]) {
+  int reps = benchArg(argc, argv, 1, 2000);
+  pstashAccess<RequireEveryCall>(
+    "PStash[], string per call", reps);
+  pstashAccess<Checked>("PStash[], Checked", reps);
+  pstashAccess<Unchecked>(
+    "PStash[], Unchecked", reps);
+  stackPushPop<RequireEveryCall>(
+    "StackTemplate, string per call", reps);
+  stackPushPop<Checked>(
+    "StackTemplate, Checked", reps);
+  stackPushPop<Unchecked>(
+    "StackTemplate, Unchecked", reps);
+} ///:~
@@ -0,0 +1,108 @@
+//: C16:ContainerStats.h
+// Instrumentation policies for the containers
+#ifndef CONTAINERSTATS_H
+#define CONTAINERSTATS_H
+#include <ostream>
+
+// The containers inherit privately from their
+// Stats policy and call these hooks. NoStats is
+// empty and its hooks inline to nothing, so an
+// uninstrumented container is unchanged:
+class NoStats {
+public:
+  void added(long = 1) const {}
+  void fetched() const {}
+  void removed(long = 1) const {}
+  void inflated(long, long) const {}
+  void linkAllocated(long = 1) const {}
+  void linkFreed(long = 1) const {}
+  void splicedFrom(const NoStats&) const {}
+};
+
+class CountingStats {
+  // Hooks are called from const members
+  // such as operator[] and peek():
+  mutable long adds, fetches, removes, inflates;
+  mutable long bytesCopied;
+  mutable long size, peakSize;
+  mutable long capacity, peakCapacity; // Slots
+  mutable long linkAllocs, linkFrees;
+  void grew() const {
+    if(size > peakSize) peakSize = size;
+    if(capacity > peakCapacity) 
+      peakCapacity = capacity;
+  }
+public:
+  CountingStats() : adds(0), fetches(0), 
+    removes(0), inflates(0), bytesCopied(0),
+    size(0), peakSize(0), capacity(0), 
+    peakCapacity(0), linkAllocs(0), 
+    linkFrees(0) {}
+  void added(long n = 1) const {
+    adds += n;
+    size += n;
+    grew();
+  }
+  void fetched() const { fetches++; }
+  void removed(long n = 1) const {
+    removes += n;
+    size -= n;
+  }
+  // Storage grew to newCapacity slots, copying
+  // the old contents:
+  void inflated(long newCapacity, 
+    long copied) const {
+    inflates++;
+    bytesCopied += copied;
+    capacity = newCapacity;
+    grew();
+  }
+  // For linked containers, each Link is a slot:
+  void linkAllocated(long n = 1) const {
+    linkAllocs += n;
+    capacity += n;
+    grew();
+  }
+  void linkFreed(long n = 1) const {
+    linkFrees += n;
+    capacity -= n;
+  }
+  // Another container's elements were moved
+  // over wholesale:
+  void splicedFrom(const CountingStats& o) const {
+    size += o.size;
+    capacity += o.capacity;
+    grew();
+    o.size = o.capacity = 0;
+  }
+  long addCount() const { return adds; }
+  long fetchCount() const { return fetches; }
+  long removeCount() const { return removes; }
+  long inflateCount() const { return inflates; }
+  long copiedBytes() const { return bytesCopied; }
+  long currentSize() const { return size; }
+  long peakSizeSeen() const { return peakSize; }
+  long currentCapacity() const { 
+    return capacity; 
+  }
+  long peakCapacitySeen() const { 
+    return peakCapacity; 
+  }
+  long linkAllocCount() const { 
+    return linkAllocs; 
+  }
+  void dumpJSON(std::ostream& os) const {
+    os << "{\"adds\": " << adds
+       << ", \"fetches\": " << fetches
+       << ", \"removes\": " << removes
+       << ", \"inflates\": " << inflates
+       << ", \"bytesCopied\": " << bytesCopied
+       << ", \"size\": " << size
+       << ", \"peakSize\": " << peakSize
+       << ", \"capacity\": " << capacity
+       << ", \"peakCapacity\": " << peakCapacity
+       << ", \"linkAllocs\": " << linkAllocs
+       << ", \"linkFrees\": " << linkFrees << "}";
+  }
+};
+#endif // CONTAINERSTATS_H ///:~
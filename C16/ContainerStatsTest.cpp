@@ -0,0 +1,51 @@
+//: C16:ContainerStatsTest.cpp
+// Telemetry from instrumented containers
+#include "TPStash2.h"
+#include "TStack2.h"
+#include "../require.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Instrumentation off costs no space:
+static_assert(sizeof(Stack<int>) == 
+  2 * sizeof(void*), "NoStats takes up room");
+
+int main() {
+  ifstream in("ContainerStatsTest.cpp");
+  assure(in, "ContainerStatsTest.cpp");
+  PStash<string, 20, CountingStats> lines;
+  Stack<string, CountingStats> stack, other;
+  vector<string> input; // Kept apart to check
+  string line;
+  while(getline(in, line)) {
+    input.push_back(line);
+    lines.add(new string(line));
+    stack.push(new string(line));
+  }
+  require(lines.count() == int(input.size()));
+  for(int i = 0; i < lines.count(); i++)
+    require(*lines[i] == input[i], "Line lost");
+  require(*stack.peek() == input.back());
+  delete lines.remove(0);
+  for(int i = 0; i < 10; i++)
+    delete stack.pop();
+  other.push(new string("spliced"));
+  stack.splice(other);
+  const CountingStats& ps = lines.stats();
+  require(ps.addCount() == lines.count(), "adds");
+  require(ps.currentSize() == lines.count() - 1,
+    "remove() shrinks the size");
+  require(ps.peakCapacitySeen() >= lines.count(),
+    "capacity high-water mark");
+  require(stack.stats().currentSize() == 
+    lines.count() - 10 + 1, "splice moves size");
+  require(other.stats().currentSize() == 0);
+  cout << "{\"pstash\": ";
+  ps.dumpJSON(cout);
+  cout << ",\n \"stack\": ";
+  stack.stats().dumpJSON(cout);
+  cout << "}" << endl;
+} ///:~
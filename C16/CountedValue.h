@@ -0,0 +1,159 @@
+//: C16:CountedValue.h
+// A value that counts how it is made and copied
+#ifndef COUNTEDVALUE_H
+#define COUNTEDVALUE_H
+#include "../require.h"
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// One set of counts, or the difference
+// between two snapshots of them:
+struct CopyCounts {
+  long defaults = 0;    // T()
+  long values = 0;      // Made from a T
+  long copies = 0;      // Copy-constructed
+  long moves = 0;       // Move-constructed
+  long copyAssigns = 0;
+  long moveAssigns = 0;
+  long destroys = 0;
+  long constructed() const {
+    return defaults + values + copies + moves;
+  }
+  long live() const {
+    return constructed() - destroys;
+  }
+  // Every operation that duplicated a value:
+  long allCopies() const {
+    return copies + copyAssigns;
+  }
+  friend CopyCounts operator-(
+    const CopyCounts& a, const CopyCounts& b) {
+    CopyCounts d;
+    d.defaults = a.defaults - b.defaults;
+    d.values = a.values - b.values;
+    d.copies = a.copies - b.copies;
+    d.moves = a.moves - b.moves;
+    d.copyAssigns = a.copyAssigns - b.copyAssigns;
+    d.moveAssigns = a.moveAssigns - b.moveAssigns;
+    d.destroys = a.destroys - b.destroys;
+    return d;
+  }
+  friend std::ostream& operator<<(
+    std::ostream& os, const CopyCounts& c) {
+    return os << "defaults " << c.defaults
+      << ", values " << c.values
+      << ", copies " << c.copies
+      << ", moves " << c.moves
+      << ", copy assigns " << c.copyAssigns
+      << ", move assigns " << c.moveAssigns
+      << ", destroys " << c.destroys;
+  }
+};
+
+// Wraps a T and counts, without printing,
+// every way a CountedValue is constructed,
+// assigned and destroyed. Use a distinct Tag
+// to keep one test's counts apart from
+// another's:
+template<class T, class Tag = void>
+class CountedValue {
+  T v;
+  struct Counters {
+    std::atomic<long> defaults{0}, values{0},
+      copies{0}, moves{0}, copyAssigns{0},
+      moveAssigns{0}, destroys{0};
+  };
+  static Counters& counters() {
+    static Counters c;
+    return c;
+  }
+  static void bump(std::atomic<long>& n) {
+    n.fetch_add(1, std::memory_order_relaxed);
+  }
+public:
+  CountedValue() : v() {
+    bump(counters().defaults);
+  }
+  CountedValue(const T& x) : v(x) {
+    bump(counters().values);
+  }
+  CountedValue(T&& x) : v(std::move(x)) {
+    bump(counters().values);
+  }
+  CountedValue(const CountedValue& rv)
+    : v(rv.v) { bump(counters().copies); }
+  // noexcept when T's move is, so that
+  // std::vector moves rather than copies on
+  // growth, as it would for T itself:
+  CountedValue(CountedValue&& rv) noexcept(
+    std::is_nothrow_move_constructible<T>::value)
+    : v(std::move(rv.v)) {
+    bump(counters().moves);
+  }
+  CountedValue& operator=(const CountedValue& rv) {
+    v = rv.v;
+    bump(counters().copyAssigns);
+    return *this;
+  }
+  CountedValue& operator=(CountedValue&& rv)
+    noexcept(
+    std::is_nothrow_move_assignable<T>::value) {
+    v = std::move(rv.v);
+    bump(counters().moveAssigns);
+    return *this;
+  }
+  ~CountedValue() { bump(counters().destroys); }
+  T& value() { return v; }
+  const T& value() const { return v; }
+  friend bool operator==(const CountedValue& a,
+    const CountedValue& b) { return a.v == b.v; }
+  friend bool operator!=(const CountedValue& a,
+    const CountedValue& b) { return a.v != b.v; }
+  static CopyCounts counts() {
+    Counters& c = counters();
+    CopyCounts r;
+    r.defaults = c.defaults;
+    r.values = c.values;
+    r.copies = c.copies;
+    r.moves = c.moves;
+    r.copyAssigns = c.copyAssigns;
+    r.moveAssigns = c.moveAssigns;
+    r.destroys = c.destroys;
+    return r;
+  }
+  // Takes a snapshot on construction; delta()
+  // is what happened since. The require
+  // functions check a region of code:
+  class Scope {
+    CopyCounts start;
+  public:
+    Scope() : start(counts()) {}
+    CopyCounts delta() const {
+      return counts() - start;
+    }
+    void reset() { start = counts(); }
+    void requireNoCopies(
+      const std::string& what) const {
+      CopyCounts d = delta();
+      require(d.allCopies() == 0, what +
+        ": " + std::to_string(d.allCopies()) +
+        " unexpected copies");
+    }
+    void requireNoneMade(
+      const std::string& what) const {
+      CopyCounts d = delta();
+      require(d.constructed() == 0 &&
+        d.copyAssigns + d.moveAssigns == 0,
+        what + ": values were made or assigned");
+    }
+    void requireBalanced(
+      const std::string& what) const {
+      require(delta().live() == 0, what +
+        ": values constructed but not destroyed");
+    }
+  };
+};
+#endif // COUNTEDVALUE_H ///:~
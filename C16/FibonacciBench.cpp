@@ -0,0 +1,55 @@
+//: C16:FibonacciBench.cpp
+//{L} fibonacci
+// Fast doubling vs. the old linear approach
+#include "fibonacci.h"
+#include "../bench.h"
+#include <cstdio>
+using namespace std;
+
+// The old algorithm, one addition per step,
+// carried over to arbitrary precision:
+BigUnsigned linearFibonacci(long n) {
+  BigUnsigned a = 1, b = 1;
+  for(long i = 0; i < n; i++) {
+    BigUnsigned c = a + b;
+    a = b;
+    b = c;
+  }
+  return a;
+}
+
+int main(int argc, char* argv[]) {
+  long maxN = benchArg(argc, argv, 1, 1000000);
+  const int reps = 1000000;
+  Timer t;
+  uint64_t sum = 0;
+  for(int i = 0; i < reps; i++)
+    sum += fibonacci64(i % 93);
+  report("fibonacci64, table", t.seconds(),
+    reps);
+#if defined(__SIZEOF_INT128__)
+  t.reset();
+  for(int i = 0; i < reps; i++)
+    sum += uint64_t(fibonacci128(93 + i % 92));
+  report("fibonacci128, fast doubling", 
+    t.seconds(), reps);
+#endif
+  keep(sum);
+  for(long n = 10; n <= maxN; n *= 10) {
+    t.reset();
+    BigUnsigned f = bigFibonacci(n);
+    double fast = t.seconds();
+    double slow = -1;
+    if(n <= 100000) {
+      t.reset();
+      BigUnsigned g = linearFibonacci(n);
+      slow = t.seconds();
+      if(f != g) printf("mismatch at %ld\n", n);
+    }
+    printf("n = %-8ld %7zu limbs  fast doubling "
+      "%10.3f ms", n, f.limbs(), fast * 1e3);
+    if(slow >= 0) printf("  linear %10.3f ms", 
+      slow * 1e3);
+    printf("\n");
+  }
+} ///:~
@@ -0,0 +1,61 @@
+//: C16:FibonacciTest.cpp
+//{L} fibonacci
+// Every fibonacci() variant agrees
+#include "fibonacci.h"
+#include "../require.h"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Evaluated by the compiler:
+static_assert(fibonacci64(10) == 89, "table");
+static_assert(fibonacci64(92) == 
+  12200160415121876738ULL, "last 64-bit value");
+
+int main() {
+  // Reference values by plain addition:
+  BigUnsigned a = 1, b = 1; // fibonacci(0), (1)
+  for(int n = 0; n < 3000; n++) {
+    if(n <= 45)
+      require(fibonacci(n) == int(a.low64()));
+    if(n <= 92)
+      require(fibonacci64(n) == a.low64());
+#if defined(__SIZEOF_INT128__)
+    if(n <= 184) {
+      require(uint64_t(fibonacci128(n)) == 
+        a.low64(), "fibonacci128 low bits");
+      if(n >= 2)
+        require(fibonacci128(n) ==
+          fibonacci128(n - 1) +
+          fibonacci128(n - 2),
+          "fibonacci128 recurrence");
+    }
+#endif
+    require(bigFibonacci(n) == a,
+      "bigFibonacci");
+    BigUnsigned c = a + b;
+    a = b;
+    b = c;
+  }
+  string f999 = bigFibonacci(999).toString();
+  cout << "fibonacci(999) has " << f999.size()
+       << " digits: " << f999.substr(0, 20) 
+       << "..." << endl;
+  require(f999.substr(0, 10) == "4346655768",
+    "Known leading digits of F(1000)");
+  // No shared state, so threads may all call it:
+  vector<thread> ts;
+  vector<int> ok(4);
+  for(int t = 0; t < 4; t++)
+    ts.push_back(thread([&ok, t] {
+      ok[t] = bigFibonacci(5000 + t) + 
+        bigFibonacci(5001 + t) == 
+        bigFibonacci(5002 + t);
+    }));
+  for(int t = 0; t < 4; t++) {
+    ts[t].join();
+    require(ok[t], "Concurrent calls agree");
+  }
+} ///:~
@@ -6,66 +6,167 @@
 // Simple stack template with nested iterator
 #ifndef ITERSTACKTEMPLATE_H
 #define ITERSTACKTEMPLATE_H
-#include "../require.h"
+#include "BoundsCheck.h"
+#include <cstddef>
 #include <iostream>
+#include <iterator>
+#include <type_traits>
 
-template<class T, int ssize = 100>
+template<class T, int ssize = 100, 
+  class Bounds = DefaultBounds>
 class StackTemplate {
   T stack[ssize];
   int top;
 public:
   StackTemplate() : top(0) {}
   void push(const T& i) {
-    require(top < ssize, "Too many push()es");
+    Bounds::check(top < ssize,
+      "Too many push()es");
     stack[top++] = i;
   }
   T pop() {
-    require(top > 0, "Too many pop()s");
+    Bounds::check(top > 0, "Too many pop()s");
     return stack[--top];
   }
-  class iterator; // Declaration required
-  friend class iterator; // Make it a friend
-  class iterator { // Now define it
-    StackTemplate& s;
+  // Random-access iterator over the elements,
+  // bottom to top. Ref is T& or const T&:
+  template<class Ref, class Owner> class Iter;
+  template<class Ref, class Owner> 
+  friend class Iter;
+  template<class Ref, class Owner> class Iter {
+    Owner* s;
     int index;
+    template<class R, class O> friend class Iter;
   public:
-    iterator(StackTemplate& st): s(st),index(0){}
+    typedef std::random_access_iterator_tag 
+      iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef typename 
+      std::remove_reference<Ref>::type* pointer;
+    typedef Ref reference;
+    Iter() : s(0), index(0) {}
+    Iter(Owner& st): s(&st),index(0){}
     // To create the "end sentinel" iterator:
-    iterator(StackTemplate& st, bool) 
-      : s(st), index(s.top) {}
-    T operator*() const { return s.stack[index];}
-    T operator++() { // Prefix form
-      require(index < s.top, 
+    Iter(Owner& st, bool) 
+      : s(&st), index(st.top) {}
+    Iter(const Iter&) = default;
+    Iter& operator=(const Iter&) = default;
+    // iterator converts to const_iterator. A
+    // template, so it isn't also the copy
+    // constructor of iterator:
+    template<class R, class = typename
+      std::enable_if<std::is_same<R, T&>::value
+      >::type>
+    Iter(const Iter<R, StackTemplate>& rv)
+      : s(rv.s), index(rv.index) {}
+    reference operator*() const { 
+      return s->stack[index];
+    }
+    pointer operator->() const { 
+      return &s->stack[index];
+    }
+    Iter& operator++() { // Prefix form
+      Bounds::check(index < s->top, 
         "iterator moved out of range");
-      return s.stack[++index];
+      ++index;
+      return *this;
     }
-    T operator++(int) { // Postfix form
-      require(index < s.top, 
+    Iter operator++(int) { // Postfix form
+      Iter old(*this);
+      operator++();
+      return old;
+    }
+    Iter& operator--() {
+      Bounds::check(index > 0, 
         "iterator moved out of range");
-      return s.stack[index++];
+      --index;
+      return *this;
     }
-    // Jump an iterator forward
-    iterator& operator+=(int amount) {
-      require(index + amount < s.top,
+    Iter operator--(int) {
+      Iter old(*this);
+      operator--();
+      return old;
+    }
+    // Jump an iterator forward (or back with
+    // a negative amount); end() is in bounds:
+    Iter& operator+=(difference_type amount) {
+      Bounds::check(index + amount <= s->top &&
+        index + amount >= 0,
         " StackTemplate::iterator::operator+=() "
         "tried to move out of bounds");
       index += amount;
       return *this;
     }
-    // To see if you're at the end:
-    bool operator==(const iterator& rv) const {
+    Iter& operator-=(difference_type amount) {
+      return *this += -amount;
+    }
+    Iter operator+(
+      difference_type amount) const {
+      Iter ret(*this);
+      return ret += amount;
+    }
+    friend Iter operator+(difference_type amount,
+      const Iter& it) { return it + amount; }
+    Iter operator-(
+      difference_type amount) const {
+      Iter ret(*this);
+      return ret -= amount;
+    }
+    template<class R, class O>
+    difference_type operator-(
+      const Iter<R, O>& rv) const {
+      return index - rv.index;
+    }
+    reference operator[](
+      difference_type n) const {
+      return *(*this + n);
+    }
+    // To see if you're at the end, and order:
+    template<class R, class O>
+    bool operator==(const Iter<R, O>& rv) const {
       return index == rv.index;
     }
-    bool operator!=(const iterator& rv) const {
+    template<class R, class O>
+    bool operator!=(const Iter<R, O>& rv) const {
       return index != rv.index;
     }
+    template<class R, class O>
+    bool operator<(const Iter<R, O>& rv) const {
+      return index < rv.index;
+    }
+    template<class R, class O>
+    bool operator>(const Iter<R, O>& rv) const {
+      return index > rv.index;
+    }
+    template<class R, class O>
+    bool operator<=(const Iter<R, O>& rv) const {
+      return index <= rv.index;
+    }
+    template<class R, class O>
+    bool operator>=(const Iter<R, O>& rv) const {
+      return index >= rv.index;
+    }
     friend std::ostream& operator<<(
-      std::ostream& os, const iterator& it) {
+      std::ostream& os, const Iter& it) {
       return os << *it;
     }
   };
+  typedef Iter<T&, StackTemplate> iterator;
+  typedef Iter<const T&, const StackTemplate>
+    const_iterator;
   iterator begin() { return iterator(*this); }
   // Create the "end sentinel":
   iterator end() { return iterator(*this, true);}
+  const_iterator begin() const { 
+    return const_iterator(*this); 
+  }
+  const_iterator end() const { 
+    return const_iterator(*this, true);
+  }
+  const_iterator cbegin() const {
+    return begin();
+  }
+  const_iterator cend() const { return end(); }
 };
 #endif // ITERSTACKTEMPLATE_H ///:~
@@ -0,0 +1,88 @@
+//: C16:IteratorTest.cpp
+// The containers work with the Standard
+// algorithms and range-based for
+#include "TPStash2.h"
+#include "TStack2.h"
+#include "IterStackTemplate.h"
+#include "../require.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#if __has_include(<execution>)
+#include <execution>
+#endif
+using namespace std;
+
+template<class It, class Tag>
+void checkCategory() {
+  static_assert(is_same<typename 
+    iterator_traits<It>::iterator_category, 
+    Tag>::value, "Wrong iterator category");
+}
+
+int main() {
+  checkCategory<Stack<int>::iterator, 
+    forward_iterator_tag>();
+  checkCategory<Stack<int>::const_iterator, 
+    forward_iterator_tag>();
+  checkCategory<PStash<int>::iterator, 
+    random_access_iterator_tag>();
+  checkCategory<StackTemplate<int>::
+    const_iterator, random_access_iterator_tag>();
+  // TStack2: equality now really compares:
+  Stack<string> words;
+  const char* w[] = { "four", "three", "two", 
+    "one" };
+  for(int i = 0; i < 4; i++)
+    words.push(new string(w[i]));
+  require(words.begin() != ++words.begin(),
+    "Distinct positions compare unequal");
+  require(distance(words.begin(), words.end())
+    == 4, "distance() over TStack2");
+  const Stack<string>& cw = words;
+  Stack<string>::const_iterator ci = 
+    find_if(cw.begin(), cw.end(), 
+      [](const string* s) { return *s == "two"; });
+  require(ci != cw.end() && **ci == "two");
+  for(string* s : words)
+    cout << *s << ' ';
+  cout << endl;
+  // PStash: random access, postfix by value:
+  PStash<int> ints;
+  for(int i = 0; i < 10; i++)
+    ints.add(new int(9 - i));
+  PStash<int>::iterator a = ints.begin(), 
+    b = a++;
+  require(b == ints.begin() && a - b == 1,
+    "Postfix ++ returns the old position");
+  require(ints.end() - ints.begin() == 10);
+  require(*ints.begin()[3] == 6, "operator[]");
+  sort(ints.begin(), ints.end(), 
+    [](int* x, int* y) { return *x < *y; });
+  for(int* i : ints)
+    cout << *i << ' ';
+  cout << endl;
+  // StackTemplate: references, not copies:
+  StackTemplate<int> is;
+  for(int i = 0; i < 20; i++)
+    is.push(i);
+  for(int& i : is)
+    i *= 2;
+  require(accumulate(is.begin(), is.end(), 0)
+    == 380, "Modified in place");
+  StackTemplate<int>::iterator mid = 
+    lower_bound(is.begin(), is.end(), 20);
+  require(mid - is.begin() == 10, "lower_bound");
+#if defined(__cpp_lib_execution)
+  // The execution-policy overloads want
+  // forward iterators. seq needs no thread
+  // library (libstdc++'s par needs -ltbb):
+  for_each(execution::seq, is.begin(), is.end(),
+    [](int& i) { i++; });
+  require(is.pop() == 39, "Policy for_each");
+#endif
+  cout << "iterators conform" << endl;
+} ///:~
@@ -0,0 +1,244 @@
+//: C16:LeakTracker.h
+// Cheap live-object counts for leak checks
+#ifndef LEAKTRACKER_H
+#define LEAKTRACKER_H
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <vector>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+// Each thread counts into its own shard, so
+// a create or destroy is a thread-local
+// lookup and two uncontended stores. Only
+// live() and report() visit every shard.
+// When a thread exits, its counts are folded
+// into the retired totals and its shards are
+// reused by later threads, so there are only
+// as many as threads alive at once. Logging
+// is off unless logging(true) is called or
+// LEAKTRACKER_LOG is set:
+class LeakTracker {
+  struct Shard {
+    // Written only by the owning thread:
+    std::atomic<long> created{0}, destroyed{0};
+  };
+  std::string nm;
+  // Slot in each thread's cache:
+  std::size_t index;
+  std::atomic<bool> log, strict;
+  mutable std::mutex lock; // Guards the rest
+  std::vector<std::unique_ptr<Shard>> shards;
+  std::vector<Shard*> inUse, spare;
+  long retiredCreated = 0, retiredDestroyed = 0;
+  static std::size_t nextIndex() {
+    static std::atomic<std::size_t> n{0};
+    return n++;
+  }
+  // A thread's shards, handed back when the
+  // thread exits:
+  struct Slot {
+    LeakTracker* tracker;
+    Shard* shard;
+  };
+  struct ThreadCache {
+    std::vector<Slot> slots;
+    ~ThreadCache() {
+      for(Slot& s : slots)
+        if(s.shard) s.tracker->retire(s.shard);
+      slots.clear();
+      gone() = true;
+    }
+  };
+  static ThreadCache& cache() {
+    thread_local ThreadCache c;
+    return c;
+  }
+  // Set once this thread's cache is destroyed;
+  // later counts go straight to the totals:
+  static bool& gone() {
+    thread_local bool g = false;
+    return g;
+  }
+  Shard* shard() {
+    if(gone()) return 0;
+    std::vector<Slot>& c = cache().slots;
+    if(index < c.size() && c[index].shard)
+      return c[index].shard;
+    return addShard();
+  }
+  Shard* addShard() {
+    std::vector<Slot>& c = cache().slots;
+    if(c.size() <= index)
+      c.resize(index + 1, Slot{0, 0});
+    std::lock_guard<std::mutex> g(lock);
+    Shard* s;
+    if(!spare.empty()) {
+      s = spare.back();
+      spare.pop_back();
+    } else {
+      shards.emplace_back(new Shard);
+      s = shards.back().get();
+    }
+    inUse.push_back(s);
+    c[index] = Slot{this, s};
+    return s;
+  }
+  // Called by the owning thread as it exits:
+  void retire(Shard* s) {
+    std::lock_guard<std::mutex> g(lock);
+    retiredCreated += s->created;
+    retiredDestroyed += s->destroyed;
+    s->created = 0;
+    s->destroyed = 0;
+    for(std::size_t i = 0; i < inUse.size(); i++)
+      if(inUse[i] == s) {
+        inUse[i] = inUse.back();
+        inUse.pop_back();
+        break;
+      }
+    spare.push_back(s);
+  }
+  // exit() may already be running, so leave
+  // with _Exit() once the output is out:
+  static void fail() {
+    std::cout.flush();
+    std::cerr.flush();
+    std::_Exit(1);
+  }
+  static void bump(std::atomic<long>& n) {
+    n.store(n.load(std::memory_order_relaxed)
+      + 1, std::memory_order_relaxed);
+  }
+  LeakTracker(const LeakTracker&);
+  void operator=(const LeakTracker&);
+public:
+  explicit LeakTracker(const std::string& name)
+    : nm(name), index(nextIndex()),
+      log(std::getenv("LEAKTRACKER_LOG") != 0),
+      strict(false) {}
+  // The summary at exit. Shards are freed
+  // here, so no tracked object, and no thread
+  // that used it, may outlive its tracker:
+  ~LeakTracker() {
+    long n = live();
+    if(n != 0 || logging())
+      report(std::cerr);
+    if(n != 0 && failing()) fail();
+  }
+  const std::string& name() const { return nm; }
+  bool logging() const {
+    return log.load(std::memory_order_relaxed);
+  }
+  void logging(bool on) {
+    log.store(on, std::memory_order_relaxed);
+  }
+  // Strict: a leak at exit, or more destroys
+  // than creates (a double delete), ends the
+  // process with status 1. Each destroy then
+  // sums the shards, so keep it for tests:
+  bool failing() const {
+    return strict.load(
+      std::memory_order_relaxed);
+  }
+  void failing(bool on) {
+    strict.store(on, std::memory_order_relaxed);
+  }
+  void created() {
+    if(Shard* s = shard()) bump(s->created);
+    else {
+      std::lock_guard<std::mutex> g(lock);
+      retiredCreated++;
+    }
+  }
+  void destroyed() {
+    if(Shard* s = shard()) bump(s->destroyed);
+    else {
+      std::lock_guard<std::mutex> g(lock);
+      retiredDestroyed++;
+    }
+    if(failing() && live() < 0) {
+      report(std::cerr);
+      fail();
+    }
+  }
+  long createdCount() const {
+    std::lock_guard<std::mutex> g(lock);
+    long n = retiredCreated;
+    for(const Shard* s : inUse) n += s->created;
+    return n;
+  }
+  long destroyedCount() const {
+    std::lock_guard<std::mutex> g(lock);
+    long n = retiredDestroyed;
+    for(const Shard* s : inUse)
+      n += s->destroyed;
+    return n;
+  }
+  // Shards ever allocated: at most the number
+  // of threads that used this tracker at once:
+  std::size_t shardCount() const {
+    std::lock_guard<std::mutex> g(lock);
+    return shards.size();
+  }
+  // Exact once the threads involved are
+  // quiet; a snapshot while they run:
+  long live() const {
+    return createdCount() - destroyedCount();
+  }
+  void report(std::ostream& os) const {
+    long c = createdCount(),
+      d = destroyedCount();
+    os << "LeakTracker " << nm << ": " << c
+       << " created, " << d << " destroyed";
+    if(c > d)
+      os << ", " << c - d << " leaked";
+    else if(d > c)
+      os << ", " << d - c
+         << " extra destroys (double delete?)";
+    os << std::endl;
+  }
+};
+
+// The readable name of T for reports:
+template<class T> std::string leakName() {
+  const char* raw = typeid(T).name();
+#if defined(__GNUG__)
+  int status = 0;
+  char* s = abi::__cxa_demangle(
+    raw, 0, 0, &status);
+  if(status == 0 && s) {
+    std::string result(s);
+    std::free(s);
+    return result;
+  }
+#endif
+  return raw;
+}
+
+// Inherit to have every T counted by one
+// LeakTracker per type. Copies count as new
+// objects; assignment changes nothing:
+template<class T> class LeakTracked {
+protected:
+  LeakTracked() { tracker().created(); }
+  LeakTracked(const LeakTracked&) {
+    tracker().created();
+  }
+  LeakTracked& operator=(const LeakTracked&) {
+    return *this;
+  }
+  ~LeakTracked() { tracker().destroyed(); }
+public:
+  static LeakTracker& tracker() {
+    static LeakTracker t(leakName<T>());
+    return t;
+  }
+};
+#endif // LEAKTRACKER_H ///:~
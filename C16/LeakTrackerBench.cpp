@@ -0,0 +1,49 @@
+//: C16:LeakTrackerBench.cpp
+// LeakTracker vs. the old set of pointers
+#include "LeakTracker.h"
+#include "../bench.h"
+#include <set>
+#include <vector>
+using namespace std;
+
+// The scheme AutoCounter used to have,
+// minus the printing:
+class SetTracked {
+  static set<SetTracked*>& trace() {
+    static set<SetTracked*> s;
+    return s;
+  }
+public:
+  SetTracked() { trace().insert(this); }
+  ~SetTracked() { trace().erase(this); }
+  static size_t live() { return trace().size(); }
+};
+
+struct Counted : LeakTracked<Counted> {};
+struct Traced : SetTracked {};
+struct Plain {};
+
+template<class T>
+double churn(int live, int rounds) {
+  vector<T*> v(live);
+  Timer t;
+  for(int r = 0; r < rounds; r++) {
+    for(auto& p : v) p = new T;
+    for(auto p : v) delete p;
+  }
+  return t.seconds();
+}
+
+int main(int argc, char* argv[]) {
+  int live = benchArg(argc, argv, 1, 100000);
+  int rounds = benchArg(argc, argv, 2, 20);
+  long ops = long(live) * rounds;
+  report("untracked new/delete",
+    churn<Plain>(live, rounds), ops);
+  report("LeakTracked new/delete",
+    churn<Counted>(live, rounds), ops);
+  report("set-tracked new/delete",
+    churn<Traced>(live, rounds), ops);
+  keep(Counted::tracker().live() + 
+    long(SetTracked::live()));
+} ///:~
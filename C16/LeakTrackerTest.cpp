@@ -0,0 +1,116 @@
+//: C16:LeakTrackerTest.cpp
+// Counts across threads, copies and leaks
+#include "LeakTracker.h"
+#include "../require.h"
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+using namespace std;
+
+// Run f in a child process; its exit status:
+int statusOf(void (*f)()) {
+  cout.flush();
+  pid_t pid = fork();
+  if(pid == 0) {
+    f();
+    _exit(0);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return WIFEXITED(status) ?
+    WEXITSTATUS(status) : -1;
+}
+
+class Widget : public LeakTracked<Widget> {
+  int v;
+public:
+  Widget(int i = 0) : v(i) {}
+  int value() const { return v; }
+};
+
+class Gadget : public LeakTracked<Gadget> {};
+
+int main() {
+  LeakTracker& wt = Widget::tracker();
+  require(wt.name() == "Widget", wt.name());
+  {
+    Widget a(1), b(a); // A copy is an object
+    b = a; // Assignment is not
+    require(wt.live() == 2);
+    require(wt.createdCount() == 2);
+  }
+  require(wt.live() == 0);
+  // Create on one thread, destroy on others;
+  // the per-thread counts still sum to zero:
+  const int nThreads = 4, perThread = 10000;
+  vector<Widget*> made(nThreads * perThread);
+  vector<thread> threads;
+  for(int t = 0; t < nThreads; t++)
+    threads.emplace_back([&made, t] {
+      for(int i = 0; i < perThread; i++)
+        made[t * perThread + i] = new Widget(i);
+    });
+  for(auto& th : threads) th.join();
+  threads.clear();
+  require(wt.live() == nThreads * perThread);
+  for(int t = 0; t < nThreads; t++)
+    threads.emplace_back([&made, t] {
+      // Each thread frees another's objects:
+      int from = (t + 1) % nThreads;
+      for(int i = 0; i < perThread; i++)
+        delete made[from * perThread + i];
+    });
+  for(auto& th : threads) th.join();
+  require(wt.live() == 0, "Widgets leaked");
+  require(wt.destroyedCount() == 
+    wt.createdCount());
+  // Threads come and go; their shards are
+  // reused, and their counts kept:
+  long before = wt.createdCount();
+  vector<Widget*> kept;
+  for(int t = 0; t < 200; t++)
+    thread([&kept] {
+      Widget w(1);
+      kept.push_back(new Widget(2));
+    }).join();
+  require(wt.createdCount() == before + 400);
+  require(wt.live() == 200);
+  require(wt.shardCount() <= nThreads + 1,
+    "Shards not reused");
+  for(Widget* w : kept) delete w;
+  require(wt.live() == 0);
+  // Each type has its own tracker:
+  Gadget* g = new Gadget;
+  require(Gadget::tracker().live() == 1);
+  require(wt.live() == 0);
+  delete g;
+  require(Gadget::tracker().live() == 0);
+  // A strict tracker fails the process on a
+  // leak, and on more destroys than creates:
+  require(statusOf([] {
+    LeakTracker t("Strict");
+    t.failing(true);
+    t.created();
+    t.created();
+    t.destroyed();
+  }) == 1, "Strict tracker missed a leak");
+  require(statusOf([] {
+    LeakTracker t("Strict");
+    t.failing(true);
+    t.created();
+    t.destroyed();
+    t.destroyed();
+    _exit(0);
+  }) == 1, "Strict tracker missed a "
+    "double delete");
+  require(statusOf([] {
+    LeakTracker t("Strict");
+    t.failing(true);
+    t.created();
+    t.destroyed();
+  }) == 0, "Strict tracker failed a clean run");
+  // A leak is reported at exit:
+  new Gadget;
+  Gadget::tracker().report(cout);
+} ///:~
@@ -0,0 +1,230 @@
+//: C16:MPMCQueue.h
+// Bounded multi-producer/multi-consumer FIFO
+#ifndef MPMCQUEUE_H
+#define MPMCQUEUE_H
+#include "../require.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+
+// A ring of Slots, each with a sequence number
+// (D. Vyukov's design). A Slot at position pos
+// is free for a producer when seq == pos, and
+// holds data for a consumer when seq == pos + 1.
+// No locks; a push or pop is one CAS in the
+// uncontended case.
+template<class T>
+class MPMCQueue {
+  struct Slot {
+    std::atomic<std::size_t> seq;
+    alignas(T) unsigned char storage[sizeof(T)];
+    T* data() { return (T*)storage; }
+  };
+  enum { cacheLine = 64 };
+  Slot* slots;
+  const std::size_t mask;
+  // Separate lines, so producers and consumers
+  // don't fight over the same cache line:
+  alignas(cacheLine) 
+    std::atomic<std::size_t> enqueuePos;
+  alignas(cacheLine) 
+    std::atomic<std::size_t> dequeuePos;
+  // Claim up to n consecutive Slots from pos,
+  // whose seq must be pos + i + offset. Returns
+  // the number claimed, with the start in pos:
+  std::size_t claim(std::atomic<std::size_t>& 
+    position, std::size_t n, std::size_t offset,
+    std::size_t& pos) {
+    pos = position.load(std::memory_order_relaxed);
+    for(;;) {
+      std::size_t k = 0;
+      while(k < n) {
+        std::size_t seq = slots[(pos + k) & mask]
+          .seq.load(std::memory_order_acquire);
+        if(seq != pos + k + offset) break;
+        k++;
+      }
+      if(k == 0) {
+        std::size_t seq = slots[pos & mask]
+          .seq.load(std::memory_order_acquire);
+        // Behind: the ring is full (or empty):
+        if(long(seq - (pos + offset)) < 0)
+          return 0;
+        // Another thread moved position on:
+        pos = position.load(
+          std::memory_order_relaxed);
+        continue;
+      }
+      if(position.compare_exchange_weak(pos, 
+        pos + k, std::memory_order_relaxed))
+        return k;
+    }
+  }
+  MPMCQueue(const MPMCQueue&);
+  void operator=(const MPMCQueue&);
+public:
+  // capacity must be a power of two:
+  explicit MPMCQueue(std::size_t capacity)
+    : slots(new Slot[capacity]), 
+      mask(capacity - 1),
+      enqueuePos(0), dequeuePos(0) {
+    require(capacity >= 2 && 
+      (capacity & (capacity - 1)) == 0,
+      "MPMCQueue capacity must be a power of 2");
+    for(std::size_t i = 0; i < capacity; i++)
+      slots[i].seq.store(i, 
+        std::memory_order_relaxed);
+  }
+  ~MPMCQueue() {
+    // Destroy whatever is still queued:
+    std::size_t end = enqueuePos.load();
+    for(std::size_t p = dequeuePos.load(); 
+        p != end; p++)
+      slots[p & mask].data()->~T();
+    delete []slots;
+  }
+  std::size_t capacity() const { return mask + 1; }
+  // Only moves from x if it succeeds:
+  bool tryPush(T&& x) {
+    std::size_t pos;
+    if(!claim(enqueuePos, 1, 0, pos)) 
+      return false;
+    Slot& s = slots[pos & mask];
+    new(s.storage) T(std::move(x));
+    s.seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+  bool tryPush(const T& x) {
+    T copy(x);
+    return tryPush(std::move(copy));
+  }
+  bool tryPop(T& x) {
+    std::size_t pos;
+    if(!claim(dequeuePos, 1, 1, pos)) 
+      return false;
+    Slot& s = slots[pos & mask];
+    x = std::move(*s.data());
+    s.data()->~T();
+    // Free for the producer one lap later:
+    s.seq.store(pos + mask + 1, 
+      std::memory_order_release);
+    return true;
+  }
+  // Batched forms claim several Slots with a
+  // single CAS. They move as many elements as
+  // fit (or are available), up to n, and return
+  // that number:
+  template<class Iter>
+  std::size_t tryPushN(Iter first, std::size_t n) {
+    std::size_t pos;
+    std::size_t k = claim(enqueuePos, n, 0, pos);
+    for(std::size_t i = 0; i < k; i++, ++first) {
+      Slot& s = slots[(pos + i) & mask];
+      new(s.storage) T(std::move(*first));
+      s.seq.store(pos + i + 1, 
+        std::memory_order_release);
+    }
+    return k;
+  }
+  template<class OutIter>
+  std::size_t tryPopN(OutIter out, std::size_t n) {
+    std::size_t pos;
+    std::size_t k = claim(dequeuePos, n, 1, pos);
+    for(std::size_t i = 0; i < k; i++) {
+      Slot& s = slots[(pos + i) & mask];
+      *out++ = std::move(*s.data());
+      s.data()->~T();
+      s.seq.store(pos + i + mask + 1, 
+        std::memory_order_release);
+    }
+    return k;
+  }
+  // Only a snapshot while other threads run:
+  std::size_t size() const {
+    std::size_t e = enqueuePos.load(), 
+      d = dequeuePos.load();
+    return e > d ? e - d : 0;
+  }
+};
+
+// Blocking wrapper: spins briefly on the lock-
+// free queue, then sleeps on a condition. The
+// mutex is only touched by threads that wait
+// and by the threads that wake them.
+template<class T>
+class BlockingQueue {
+  MPMCQueue<T> q;
+  std::mutex m;
+  std::condition_variable notEmpty, notFull;
+  std::atomic<int> popWaiters, pushWaiters;
+  enum { spins = 64 };
+  void wake(std::atomic<int>& waiters,
+    std::condition_variable& cv) {
+    // Pairs with the waiter's increment, so
+    // either it sees our change or we see it:
+    std::atomic_thread_fence(
+      std::memory_order_seq_cst);
+    if(waiters.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(m);
+      cv.notify_all();
+    }
+  }
+public:
+  explicit BlockingQueue(std::size_t capacity)
+    : q(capacity), popWaiters(0), 
+      pushWaiters(0) {}
+  bool tryPush(T&& x) {
+    if(!q.tryPush(std::move(x))) return false;
+    wake(popWaiters, notEmpty);
+    return true;
+  }
+  bool tryPop(T& x) {
+    if(!q.tryPop(x)) return false;
+    wake(pushWaiters, notFull);
+    return true;
+  }
+  void push(T x) {
+    for(int i = 0; i < spins; i++)
+      if(tryPush(std::move(x))) return;
+    {
+      std::unique_lock<std::mutex> lock(m);
+      pushWaiters++;
+      notFull.wait(lock, [&] { 
+        return q.tryPush(std::move(x)); });
+      pushWaiters--;
+    }
+    wake(popWaiters, notEmpty);
+  }
+  T pop() {
+    T x;
+    for(int i = 0; i < spins; i++)
+      if(tryPop(x)) return x;
+    {
+      std::unique_lock<std::mutex> lock(m);
+      popWaiters++;
+      notEmpty.wait(lock, [&] { 
+        return q.tryPop(x); });
+      popWaiters--;
+    }
+    wake(pushWaiters, notFull);
+    return x;
+  }
+  template<class Iter>
+  std::size_t tryPushN(Iter first, std::size_t n) {
+    std::size_t k = q.tryPushN(first, n);
+    if(k) wake(popWaiters, notEmpty);
+    return k;
+  }
+  template<class OutIter>
+  std::size_t tryPopN(OutIter out, std::size_t n) {
+    std::size_t k = q.tryPopN(out, n);
+    if(k) wake(pushWaiters, notFull);
+    return k;
+  }
+  std::size_t size() const { return q.size(); }
+};
+#endif // MPMCQUEUE_H ///:~
@@ -0,0 +1,94 @@
+//: C16:MPMCQueueBench.cpp
+// Throughput and latency at various P/C counts
+#include "MPMCQueue.h"
+#include "../bench.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+long nowNs() {
+  return chrono::duration_cast<chrono::nanoseconds>(
+    Clock::now().time_since_epoch()).count();
+}
+
+// Each element carries its enqueue time; every
+// 64th one is sampled for latency:
+void run(int producers, int consumers, 
+  long total, int batch) {
+  MPMCQueue<long> q(4096);
+  long perProducer = total / producers;
+  total = perProducer * producers;
+  atomic<long> consumed(0);
+  vector<vector<long> > lat(consumers);
+  vector<thread> threads;
+  Timer t;
+  for(int p = 0; p < producers; p++)
+    threads.push_back(thread([&] {
+      vector<long> buf(batch);
+      for(long i = 0; i < perProducer; ) {
+        long n = min(long(batch), perProducer - i);
+        long stamp = nowNs();
+        fill(buf.begin(), buf.begin() + n, stamp);
+        long done = 0;
+        while(done < n) {
+          long k = batch == 1 ?
+            q.tryPush(stamp) :
+            q.tryPushN(buf.begin() + done, n - done);
+          if(!k) this_thread::yield();
+          done += k;
+        }
+        i += n;
+      }
+    }));
+  for(int c = 0; c < consumers; c++)
+    threads.push_back(thread([&, c] {
+      vector<long> buf(batch);
+      long seen = 0;
+      while(consumed.load(
+          memory_order_relaxed) < total) {
+        long k = batch == 1 ? 
+          q.tryPop(buf[0]) : 
+          q.tryPopN(buf.begin(), batch);
+        if(!k) { this_thread::yield(); continue; }
+        long now = nowNs();
+        for(long i = 0; i < k; i++)
+          if((seen++ & 63) == 0)
+            lat[c].push_back(now - buf[i]);
+        consumed += k;
+      }
+    }));
+  for(size_t i = 0; i < threads.size(); i++)
+    threads[i].join();
+  double secs = t.seconds();
+  vector<long> all;
+  for(int c = 0; c < consumers; c++)
+    all.insert(all.end(), lat[c].begin(), 
+      lat[c].end());
+  sort(all.begin(), all.end());
+  // A short run may record no latencies:
+  long p50 = all.empty() ? 0 :
+    all[all.size() / 2];
+  long p99 = all.empty() ? 0 :
+    all[all.size() * 99 / 100];
+  printf("%dP/%dC batch %-3d %8.2f Mops/s"
+    "  p50 %7ld ns  p99 %8ld ns\n",
+    producers, consumers, batch, 
+    total / secs / 1e6, p50, p99);
+}
+
+int main(int argc, char* argv[]) {
+  long total = benchArg(argc, argv, 1, 4000000);
+  int pc[][2] = { {1, 1}, {1, 4}, {4, 1}, 
+    {2, 2}, {4, 4}, {8, 8} };
+  for(size_t i = 0; i < sizeof pc / sizeof *pc; 
+      i++) {
+    run(pc[i][0], pc[i][1], total, 1);
+    run(pc[i][0], pc[i][1], total, 32);
+  }
+} ///:~
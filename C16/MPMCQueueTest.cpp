@@ -0,0 +1,79 @@
+//: C16:MPMCQueueTest.cpp
+// Every element arrives exactly once
+#include "MPMCQueue.h"
+#include "../require.h"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+const int producers = 4, consumers = 4;
+const long perProducer = 200000;
+
+int main() {
+  // Single-threaded FIFO order and batches:
+  MPMCQueue<string> sq(8);
+  for(int i = 0; i < 8; i++)
+    require(sq.tryPush(to_string(i)), "Push");
+  require(!sq.tryPush(string("full")), "Full");
+  string s;
+  require(sq.tryPop(s) && s == "0", "FIFO");
+  vector<string> in(5, "x"), out;
+  require(sq.tryPushN(in.begin(), 5) == 1, 
+    "Batch push stops when full");
+  require(sq.tryPopN(back_inserter(out), 100)
+    == 8, "Batch pop takes what's there");
+  require(out[0] == "1" && out[7] == "x", "Order");
+  require(!sq.tryPop(s), "Empty");
+  // Many producers and consumers:
+  BlockingQueue<long> q(1024);
+  vector<long> sums(consumers), counts(consumers);
+  vector<thread> threads;
+  for(int p = 0; p < producers; p++)
+    threads.push_back(thread([&q, p] {
+      long batch[16];
+      long i = 0;
+      while(i < perProducer) {
+        if(i % 3 == 0) { // Mix in single pushes
+          q.push(p * perProducer + i++);
+          continue;
+        }
+        int n = 0;
+        while(n < 16 && i + n < perProducer) {
+          batch[n] = p * perProducer + i + n;
+          n++;
+        }
+        long done = 0;
+        while(done < n)
+          done += q.tryPushN(batch + done, n - done);
+        i += n;
+      }
+    }));
+  for(int c = 0; c < consumers; c++)
+    threads.push_back(thread([&, c] {
+      for(;;) {
+        long x = q.pop();
+        if(x < 0) return; // Stop marker
+        sums[c] += x;
+        counts[c]++;
+      }
+    }));
+  for(int p = 0; p < producers; p++)
+    threads[p].join();
+  for(int c = 0; c < consumers; c++)
+    q.push(-1);
+  for(int c = 0; c < consumers; c++)
+    threads[producers + c].join();
+  long total = producers * perProducer;
+  long sum = 0, count = 0;
+  for(int c = 0; c < consumers; c++) {
+    sum += sums[c];
+    count += counts[c];
+  }
+  require(count == total, "Lost or duplicated");
+  require(sum == total * (total - 1) / 2, 
+    "Wrong elements");
+  cout << count << " elements passed through" 
+       << endl;
+} ///:~
@@ -0,0 +1,131 @@
+//: C16:NoCopyTest.cpp
+// Proves the containers' hot paths don't copy
+#include "CountedValue.h"
+#include "ValueStack.h"
+#include "PersistentStack.h"
+#include "MPMCQueue.h"
+#include "PolyBuckets.h"
+#include "ParallelAlgorithm.h"
+#include "../require.h"
+#include <iostream>
+#include <iterator>
+#include <vector>
+using namespace std;
+
+// A distinct tag per test keeps counts apart:
+struct VS; struct PS; struct Q; struct PB; 
+struct PA;
+
+struct Shape { virtual ~Shape() {} };
+struct Circle : Shape {
+  CountedValue<int, PB> r;
+  explicit Circle(int i) : r(i) {}
+  int value() const { return r.value(); }
+};
+struct Square : Shape {
+  CountedValue<int, PB> side;
+  explicit Square(int i) : side(i) {}
+  int value() const { return side.value(); }
+};
+
+void valueStack() {
+  typedef CountedValue<int, VS> V;
+  Stack<V, 16> s; // Default-constructs 16
+  V::Scope scope;
+  for(int i = 0; i < 16; i++)
+    s.push(V(i)); // Move-assigned in
+  for(int i = 15; i >= 0; i--)
+    require(s.pop().value() == i);
+  scope.requireNoCopies("ValueStack push/pop");
+  cout << "ValueStack: " << scope.delta() << endl;
+}
+
+void persistentStack() {
+  typedef CountedValue<int, PS> V;
+  V::Scope scope;
+  PersistentStack<V> s;
+  for(int i = 0; i < 100; i++)
+    s = s.push(V(i));
+  // Versions share their Links; copying
+  // the stack and walking it copies no V:
+  PersistentStack<V> snapshot = s;
+  long sum = 0;
+  for(const V& v : snapshot) sum += v.value();
+  require(sum == 99 * 100 / 2);
+  require(s.peek().value() == 99);
+  scope.requireNoCopies("PersistentStack");
+  s = PersistentStack<V>();
+  snapshot = s;
+  scope.requireBalanced("PersistentStack");
+}
+
+void queue() {
+  typedef CountedValue<int, Q> V;
+  MPMCQueue<V> q(64);
+  V::Scope scope;
+  for(int i = 0; i < 64; i++)
+    require(q.tryPush(V(i)));
+  V out;
+  for(int i = 0; i < 32; i++) {
+    require(q.tryPop(out));
+    require(out.value() == i);
+  }
+  vector<V> batch(16);
+  for(int i = 0; i < 16; i++) 
+    batch[i].value() = 100 + i;
+  require(q.tryPushN(batch.begin(), 16) == 16);
+  vector<V> drained;
+  q.tryPopN(back_inserter(drained), 48);
+  require(drained.size() == 48);
+  require(drained.back().value() == 115);
+  scope.requireNoCopies("MPMCQueue");
+  // The const& overload is the one that
+  // copies, once:
+  V::Scope one;
+  V x(7);
+  q.tryPush(x);
+  require(one.delta().copies == 1);
+}
+
+void buckets() {
+  typedef CountedValue<int, PB> V;
+  PolyBuckets<Shape, Circle, Square> pb;
+  V::Scope scope;
+  // Growth moves the elements, since V's move
+  // constructor is noexcept:
+  for(int i = 0; i < 1000; i++) {
+    pb.emplace<Circle>(i);
+    pb.add(Square(i));
+  }
+  // The moved values all arrive intact:
+  long sum = 0;
+  pb.forEach([&](auto& s) { sum += s.value(); });
+  require(sum == 2 * 999 * 1000 / 2,
+    "Values lost in moves");
+  scope.requireNoCopies("PolyBuckets");
+}
+
+void parallel() {
+  typedef CountedValue<long, PA> V;
+  vector<V> v;
+  for(long i = 0; i < 10000; i++)
+    v.emplace_back(i);
+  V::Scope scope;
+  parallelForEach(v.begin(), v.end(),
+    [](V& x) { x.value() *= 2; });
+  long sum = parallelTransformReduce(
+    v.begin(), v.end(), 0L,
+    [](long a, long b) { return a + b; },
+    [](const V& x) { return x.value(); });
+  require(sum == 9999L * 10000);
+  scope.requireNoneMade("parallel algorithms");
+}
+
+int main() {
+  valueStack();
+  persistentStack();
+  queue();
+  buckets();
+  parallel();
+  cout << "No hidden copies" << endl;
+} ///:~
@@ -6,25 +6,89 @@
 // Stack with runtime conrollable ownership
 #ifndef OWNERSTACK_H
 #define OWNERSTACK_H
+#include "../C13/Arena.h"
+#include "../require.h"
+#include "ContainerStats.h"
+#include <new>
+#include <type_traits>
+#include <utility>
 
-template<class T> class Stack {
+template<class T, class Stats = NoStats> 
+class Stack : private Stats {
   struct Link {
     T* data;
     Link* next;
-    Link(T* dat, Link* nxt) 
-      : data(dat), next(nxt) {}
+    bool inArena; // data made by create()
+    Link(T* dat, Link* nxt, bool a = false)
+      : data(dat), next(nxt), inArena(a) {}
   }* head;
+  Link* tail; // Bottom Link, so splice() is O(1)
   bool own;
+  Arena* arena; // Non-zero in arena mode
+  // Set once a heap element joins an arena
+  // Stack, so teardown knows to look for it:
+  bool heapElements;
+  Link* newLink(T* dat, Link* nxt,
+    bool inArena = false) {
+    Stats::linkAllocated();
+    if(arena)
+      return new(arena->allocate(sizeof(Link),
+        alignof(Link))) Link(dat, nxt, inArena);
+    return new Link(dat, nxt);
+  }
+  void link(T* dat, bool inArena) {
+    head = newLink(dat, head, inArena);
+    if(!tail) tail = head;
+    if(arena && !inArena) heapElements = true;
+    Stats::added();
+  }
+  void freeLink(Link* l) {
+    Stats::linkFreed();
+    if(!arena) delete l; // Else the Arena's job
+  }
 public:
-  Stack(bool own = true) : head(0), own(own) {}
+  Stack(bool own = true) 
+    : head(0), tail(0), own(own), arena(0),
+      heapElements(false) {}
+  // Arena mode: Links and the elements made with
+  // create() live in a, and are freed when a is.
+  // Elements push()ed from the heap are still
+  // deleted by an owning Stack. Don't delete
+  // what pop() returns if create() made it:
+  explicit Stack(Arena& a, bool own = true)
+    : head(0), tail(0), own(own), arena(&a),
+      heapElements(false) {}
   ~Stack();
-  void push(T* dat) {
-    head = new Link(dat,head);
+  void push(T* dat) { link(dat, false); }
+  // Construct an element in the Arena and
+  // push it:
+  template<class... Args>
+  T* create(Args&&... args) {
+    require(arena != 0, 
+      "Stack::create() needs an Arena");
+    T* p = new(arena->allocate(sizeof(T),
+      alignof(T)))
+      T(std::forward<Args>(args)...);
+    link(p, true);
+    return p;
   }
   T* peek() const { 
+    Stats::fetched();
     return head ? head->data : 0; 
   }
   T* pop();
+  // Move all of other's elements onto the top
+  // of this Stack, keeping their order. They
+  // fall under this Stack's ownership:
+  void splice(Stack& other);
+  // Push a range; *(last - 1) ends up on top:
+  template<class Iter>
+  void pushRange(Iter first, Iter last);
+  // Pop up to n elements into out, top first.
+  // Returns the number actually popped:
+  template<class OutIter>
+  int popN(int n, OutIter out);
+  const Stats& stats() const { return *this; }
   bool owns() const { return own; }
   void owns(bool newownership) {
     own = newownership;
@@ -33,16 +97,97 @@ public:
   operator bool() const { return head != 0; }
 };
 
-template<class T> T* Stack<T>::pop() {
+template<class T, class Stats> 
+T* Stack<T, Stats>::pop() {
   if(head == 0) return 0;
   T* result = head->data;
   Link* oldHead = head;
   head = head->next;
-  delete oldHead;
+  if(head == 0) tail = 0;
+  freeLink(oldHead);
+  Stats::removed();
   return result;
 }
 
-template<class T> Stack<T>::~Stack() {
+template<class T, class Stats>
+void Stack<T, Stats>::splice(Stack& other) {
+  if(&other == this || other.head == 0) return;
+  require(arena == other.arena,
+    "Stack::splice() across different Arenas");
+  // Relink the whole chain in one step:
+  other.tail->next = head;
+  if(tail == 0) tail = other.tail;
+  head = other.head;
+  other.head = other.tail = 0;
+  heapElements |= other.heapElements;
+  Stats::splicedFrom(other.stats());
+}
+
+template<class T, class Stats>
+template<class Iter>
+void Stack<T, Stats>::pushRange(Iter first, 
+  Iter last) {
+  // Build the new chain off to the side, then
+  // attach it with a single head update. If
+  // the iterator or new throws, the partial
+  // chain is freed and the Stack is unchanged:
+  Link* top = 0;
+  Link* bottom = 0;
+  long n = 0;
+  try {
+    for(; first != last; ++first, n++) {
+      top = newLink(*first, top);
+      if(!bottom) bottom = top;
+    }
+  } catch(...) {
+    while(top) {
+      Link* next = top->next;
+      freeLink(top);
+      top = next;
+    }
+    throw;
+  }
+  if(!top) return;
+  if(arena) heapElements = true;
+  Stats::added(n);
+  bottom->next = head;
+  if(tail == 0) tail = bottom;
+  head = top;
+}
+
+template<class T, class Stats> 
+template<class OutIter>
+int Stack<T, Stats>::popN(int n, OutIter out) {
+  int popped = 0;
+  Link* p = head;
+  while(p && popped < n) {
+    *out++ = p->data;
+    Link* old = p;
+    p = p->next;
+    freeLink(old);
+    popped++;
+  }
+  head = p;
+  if(head == 0) tail = 0;
+  Stats::removed(popped);
+  return popped;
+}
+
+template<class T, class Stats> 
+Stack<T, Stats>::~Stack() {
+  if(arena) {
+    // The Arena releases all storage in bulk;
+    // only non-trivial destructors, or heap
+    // elements to delete, need a walk:
+    bool trivial =
+      std::is_trivially_destructible<T>::value;
+    if(own && (heapElements || !trivial))
+      for(Link* p = head; p; p = p->next) {
+        if(!p->inArena) delete p->data;
+        else if(!trivial) p->data->~T();
+      }
+    return;
+  }
   if(!own) return;
   while(head)
     delete pop();
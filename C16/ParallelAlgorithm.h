@@ -0,0 +1,116 @@
+//: C16:ParallelAlgorithm.h
+// drawAll()-style algorithms, run in parallel
+#ifndef PARALLELALGORITHM_H
+#define PARALLELALGORITHM_H
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+// The grain is the number of elements handed to
+// a thread at a time; 0 picks about four chunks
+// per thread. Ranges shorter than one grain run
+// on the calling thread.
+namespace parallelDetail {
+
+inline std::size_t chunks(std::size_t n,
+  std::size_t& grain, const ThreadPool& pool) {
+  if(grain == 0) {
+    grain = n / (pool.size() * 4);
+    if(grain == 0) grain = 1;
+  }
+  return (n + grain - 1) / grain;
+}
+
+// Forward-only iterators (such as TStack2's)
+// can't be split without a walk; run in order:
+template<class Iter, class F>
+void forEach(Iter first, Iter last, F f,
+  std::size_t, ThreadPool&,
+  std::forward_iterator_tag) {
+  std::for_each(first, last, f);
+}
+
+template<class Iter, class F>
+void forEach(Iter first, Iter last, F f,
+  std::size_t grain, ThreadPool& pool,
+  std::random_access_iterator_tag) {
+  std::size_t n = last - first;
+  std::size_t count = chunks(n, grain, pool);
+  if(count <= 1) {
+    std::for_each(first, last, f);
+    return;
+  }
+  pool.run(count, [=](std::size_t c) {
+    Iter b = first + c * grain;
+    Iter e = c + 1 == count ? last : b + grain;
+    std::for_each(b, e, f);
+  });
+}
+
+template<class Iter, class T, class Reduce,
+  class Transform>
+T transformReduce(Iter first, Iter last, T init,
+  Reduce reduce, Transform transform, 
+  std::size_t, ThreadPool&,
+  std::forward_iterator_tag) {
+  for(; first != last; ++first)
+    init = reduce(init, transform(*first));
+  return init;
+}
+
+template<class Iter, class T, class Reduce,
+  class Transform>
+T transformReduce(Iter first, Iter last, T init,
+  Reduce reduce, Transform transform, 
+  std::size_t grain, ThreadPool& pool,
+  std::random_access_iterator_tag) {
+  std::size_t n = last - first;
+  std::size_t count = chunks(n, grain, pool);
+  if(count <= 1)
+    return transformReduce(first, last, init,
+      reduce, transform, grain, pool,
+      std::forward_iterator_tag());
+  // Each chunk reduces into its own slot; the
+  // slots combine in order, so the result
+  // doesn't depend on thread timing:
+  std::vector<T> partial(count, init);
+  pool.run(count, [&](std::size_t c) {
+    Iter b = first + c * grain;
+    Iter e = c + 1 == count ? last : b + grain;
+    T acc = transform(*b);
+    for(++b; b != e; ++b)
+      acc = reduce(acc, transform(*b));
+    partial[c] = acc;
+  });
+  for(std::size_t c = 0; c < count; c++)
+    init = reduce(init, partial[c]);
+  return init;
+}
+
+} // namespace parallelDetail
+
+template<class Iter, class F>
+void parallelForEach(Iter first, Iter last, 
+  F f, std::size_t grain = 0,
+  ThreadPool& pool = ThreadPool::instance()) {
+  parallelDetail::forEach(first, last, f, grain,
+    pool, typename std::iterator_traits<Iter>::
+      iterator_category());
+}
+
+// reduce must be associative. init is used
+// once, not once per chunk:
+template<class Iter, class T, class Reduce,
+  class Transform>
+T parallelTransformReduce(Iter first, Iter last,
+  T init, Reduce reduce, Transform transform,
+  std::size_t grain = 0,
+  ThreadPool& pool = ThreadPool::instance()) {
+  return parallelDetail::transformReduce(first,
+    last, init, reduce, transform, grain, pool,
+    typename std::iterator_traits<Iter>::
+      iterator_category());
+}
+#endif // PARALLELALGORITHM_H ///:~
@@ -0,0 +1,72 @@
+//: C16:ParallelAlgorithmTest.cpp
+// One algorithm over different containers
+#include "ParallelAlgorithm.h"
+#include "TPStash2.h"
+#include "TStack2.h"
+#include "../require.h"
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+using namespace std;
+
+// A quiet Shape, for counting draw() calls:
+class Shape {
+public:
+  static atomic<long> drawn;
+  virtual void draw() { drawn++; }
+  virtual ~Shape() {}
+};
+atomic<long> Shape::drawn(0);
+
+// drawAll() from Drawing.cpp, in parallel:
+template<class Iter>
+void parallelDrawAll(Iter start, Iter end) {
+  parallelForEach(start, end, 
+    [](Shape* s) { s->draw(); });
+}
+
+int main() {
+  const int sz = 100000;
+  vector<Shape*> v;
+  PStash<Shape> ps;
+  Stack<Shape> st;
+  for(int i = 0; i < sz; i++) {
+    v.push_back(new Shape);
+    ps.add(new Shape);
+    st.push(new Shape);
+  }
+  parallelDrawAll(v.begin(), v.end());
+  parallelDrawAll(ps.begin(), ps.end());
+  // Forward-only: falls back to sequential:
+  parallelDrawAll(st.begin(), st.end());
+  require(Shape::drawn == 3L * sz, 
+    "Every Shape drawn once");
+  // Reduction with a small grain:
+  vector<long> n(sz);
+  for(int i = 0; i < sz; i++) n[i] = i;
+  long sumSq = parallelTransformReduce(
+    n.begin(), n.end(), 0L, 
+    [](long a, long b) { return a + b; },
+    [](long x) { return x * x; }, 1000);
+  long expect = 0;
+  for(int i = 0; i < sz; i++) expect += long(i)*i;
+  require(sumSq == expect, "transformReduce");
+  require(parallelTransformReduce(n.begin(), 
+    n.begin(), 47L, 
+    [](long a, long b) { return a + b; },
+    [](long x) { return x; }) == 47, 
+    "Empty range yields init");
+  // Exceptions come back to the caller:
+  bool caught = false;
+  try {
+    parallelForEach(n.begin(), n.end(), 
+      [](long x) { 
+        if(x == 5000) throw runtime_error("x"); 
+      }, 100);
+  } catch(runtime_error&) { caught = true; }
+  require(caught, "Exception propagates");
+  for(int i = 0; i < sz; i++)
+    delete v[i];
+  cout << "parallel algorithms agree" << endl;
+} ///:~
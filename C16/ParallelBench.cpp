@@ -0,0 +1,41 @@
+//: C16:ParallelBench.cpp
+// Scaling of parallelForEach/TransformReduce
+#include "ParallelAlgorithm.h"
+#include "../bench.h"
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+using namespace std;
+
+int main(int argc, char* argv[]) {
+  long n = benchArg(argc, argv, 1, 20000000);
+  vector<double> v(n, 1.5);
+  unsigned maxThreads = 
+    thread::hardware_concurrency();
+  size_t grains[] = { 0, 1024, 65536 };
+  printf("%ld elements, %u hardware threads\n",
+    n, maxThreads);
+  for(unsigned t = 1; t <= 2 * maxThreads; 
+      t *= 2) {
+    ThreadPool pool(t);
+    for(int g = 0; g < 3; g++) {
+      Timer timer;
+      parallelForEach(v.begin(), v.end(), 
+        [](double& x) { x = sqrt(x * x + 1); },
+        grains[g], pool);
+      double fe = timer.seconds();
+      timer.reset();
+      double sum = parallelTransformReduce(
+        v.begin(), v.end(), 0.0,
+        [](double a, double b) { return a + b; },
+        [](double x) { return x * 0.5; },
+        grains[g], pool);
+      double tr = timer.seconds();
+      keep(sum);
+      printf("%2u threads, grain %-6zu forEach "
+        "%8.2f ms  transformReduce %8.2f ms\n",
+        t, grains[g], fe * 1e3, tr * 1e3);
+    }
+  }
+} ///:~
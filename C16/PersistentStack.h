@@ -0,0 +1,132 @@
+//: C16:PersistentStack.h
+// Immutable Stack; versions share their Links
+#ifndef PERSISTENTSTACK_H
+#define PERSISTENTSTACK_H
+#include "../require.h"
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+// Reference-count policies. PlainCount is the
+// cheapest; use AtomicCount when versions are
+// copied or destroyed from several threads:
+class PlainCount {
+  long n;
+public:
+  PlainCount() : n(1) {}
+  void increment() { ++n; }
+  // True when the last reference goes away:
+  bool decrement() { return --n == 0; }
+};
+
+class AtomicCount {
+  std::atomic<long> n;
+public:
+  AtomicCount() : n(1) {}
+  void increment() {
+    n.fetch_add(1, std::memory_order_relaxed);
+  }
+  bool decrement() {
+    return n.fetch_sub(1, 
+      std::memory_order_acq_rel) == 1;
+  }
+};
+
+template<class T, class Count = PlainCount>
+class PersistentStack {
+  struct Link {
+    Count refs;
+    const T data;
+    Link* next; // Already acquired for us
+    Link(const T& dat, Link* nxt)
+      : data(dat), next(nxt) {}
+    Link(T&& dat, Link* nxt)
+      : data(std::move(dat)), next(nxt) {}
+  }* head;
+  explicit PersistentStack(Link* h) : head(h) {}
+  static Link* acquire(Link* p) {
+    if(p) p->refs.increment();
+    return p;
+  }
+  // A loop rather than recursion, so dropping
+  // a long chain can't overflow the call stack:
+  static void release(Link* p) {
+    while(p && p->refs.decrement()) {
+      Link* next = p->next;
+      delete p;
+      p = next;
+    }
+  }
+public:
+  PersistentStack() : head(0) {}
+  // Copying is a snapshot, and costs O(1):
+  PersistentStack(const PersistentStack& rv)
+    : head(acquire(rv.head)) {}
+  PersistentStack(PersistentStack&& rv)
+    : head(rv.head) { rv.head = 0; }
+  PersistentStack& operator=(PersistentStack rv) {
+    std::swap(head, rv.head);
+    return *this;
+  }
+  ~PersistentStack() { release(head); }
+  // Both produce a new version in O(1) and
+  // leave this one untouched:
+  PersistentStack push(const T& x) const {
+    return PersistentStack(
+      new Link(x, acquire(head)));
+  }
+  PersistentStack push(T&& x) const {
+    return PersistentStack(
+      new Link(std::move(x), acquire(head)));
+  }
+  PersistentStack pop() const {
+    require(head != 0, 
+      "PersistentStack::pop() on empty stack");
+    return PersistentStack(acquire(head->next));
+  }
+  const T& peek() const {
+    require(head != 0, 
+      "PersistentStack::peek() on empty stack");
+    return head->data;
+  }
+  bool empty() const { return head == 0; }
+  // True if not empty:
+  operator bool() const { return head != 0; }
+  // Versions that share their top Link are equal:
+  bool sameAs(const PersistentStack& rv) const {
+    return head == rv.head;
+  }
+  // Read-only traversal from the top down:
+  class iterator {
+    const Link* p;
+  public:
+    typedef std::forward_iterator_tag 
+      iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const T* pointer;
+    typedef const T& reference;
+    iterator(const Link* l = 0) : p(l) {}
+    reference operator*() const { return p->data; }
+    pointer operator->() const { return &p->data; }
+    iterator& operator++() {
+      p = p->next;
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator old(*this);
+      p = p->next;
+      return old;
+    }
+    bool operator==(const iterator& rv) const {
+      return p == rv.p;
+    }
+    bool operator!=(const iterator& rv) const {
+      return p != rv.p;
+    }
+  };
+  iterator begin() const { return iterator(head); }
+  iterator end() const { return iterator(); }
+};
+#endif // PERSISTENTSTACK_H ///:~
@@ -0,0 +1,65 @@
+//: C16:PersistentStackTest.cpp
+// Snapshots of a PersistentStack are free
+#include "PersistentStack.h"
+#include "../require.h"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+template<class PS>
+void print(const char* name, const PS& ps) {
+  cout << name << ":";
+  for(typename PS::iterator it = ps.begin();
+      it != ps.end(); it++)
+    cout << ' ' << *it;
+  cout << endl;
+}
+
+int main() {
+  // An "undo" history of edits:
+  typedef PersistentStack<string> Edits;
+  Edits v0;
+  Edits v1 = v0.push("insert");
+  Edits v2 = v1.push("delete");
+  Edits snapshot = v2; // O(1), no copying
+  Edits v3 = v2.pop().push("replace");
+  print("v2", v2);
+  print("v3", v3);
+  print("snapshot", snapshot);
+  require(snapshot.sameAs(v2), "Snapshot shares");
+  require(v3.pop().sameAs(v1), "Tail is shared");
+  require(v0.empty() && v2.peek() == "delete");
+  // Old versions may be read concurrently; the
+  // atomic count lets threads copy them safely:
+  typedef PersistentStack<int, AtomicCount> IS;
+  IS big;
+  const int sz = 100000;
+  for(int i = 0; i < sz; i++)
+    big = big.push(i);
+  vector<long> sums(4);
+  vector<thread> readers;
+  for(int t = 0; t < 4; t++)
+    readers.push_back(thread([&, t] {
+      IS mine = big; // Snapshot per thread
+      for(int i = 0; i < t; i++)
+        mine = mine.pop();
+      long s = 0;
+      for(IS::iterator it = mine.begin();
+          it != mine.end(); ++it)
+        s += *it;
+      sums[t] = s;
+    }));
+  for(int t = 0; t < 4; t++)
+    readers[t].join();
+  long total = long(sz) * (sz - 1) / 2;
+  require(sums[0] == total, "Reader 0 sum");
+  require(sums[3] == total - (sz-1) - (sz-2) 
+    - (sz-3), "Reader 3 sum");
+  cout << "readers agree" << endl;
+  // Releasing a long chain is iterative:
+  IS deep;
+  for(int i = 0; i < 1000000; i++)
+    deep = deep.push(i);
+} ///:~
@@ -0,0 +1,87 @@
+//: C16:PolyBuckets.h
+// Polymorphic container stored by concrete type
+#ifndef POLYBUCKETS_H
+#define POLYBUCKETS_H
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Instead of a vector<Base*> to objects scattered
+// across the heap in random type order, each
+// concrete type gets its own contiguous vector.
+// Operations run one type at a time, so the
+// function called is the same for a whole batch.
+// Inside forEach() the element has its concrete
+// type: if that type (or the member function) is
+// final, or the call is qualified (s.T::draw()),
+// the call is bound statically and can inline.
+// Adding elements may move existing ones, like
+// any vector.
+template<class Base, class... Types>
+class PolyBuckets {
+  static_assert(sizeof...(Types) > 0, 
+    "PolyBuckets needs at least one type");
+  std::tuple<std::vector<Types>...> buckets;
+  template<class F, std::size_t... I>
+  void each(F& f, std::index_sequence<I...>) {
+    // One batch per bucket, in declaration order:
+    int expand[] = { 0, 
+      (batch(std::get<I>(buckets), f), 0)... };
+    (void)expand;
+  }
+  template<class T, class F>
+  static void batch(std::vector<T>& v, F& f) {
+    T* p = v.data();
+    T* end = p + v.size();
+    for(; p != end; ++p)
+      f(*p);
+  }
+public:
+  template<class T>
+  std::vector<T>& bucket() {
+    static_assert(std::is_base_of<Base, T>::value,
+      "Type isn't derived from Base");
+    return std::get<std::vector<T> >(buckets);
+  }
+  template<class T, class... Args>
+  T& emplace(Args&&... args) {
+    std::vector<T>& b = bucket<T>();
+    b.emplace_back(std::forward<Args>(args)...);
+    return b.back();
+  }
+  template<class T>
+  T& add(T&& x) {
+    return emplace<typename 
+      std::decay<T>::type>(std::forward<T>(x));
+  }
+  template<class T>
+  void reserve(std::size_t n) { 
+    bucket<T>().reserve(n); 
+  }
+  std::size_t size() const {
+    std::size_t n = 0;
+    int expand[] = { 0, (n += std::get<
+      std::vector<Types> >(buckets).size(), 0)... };
+    (void)expand;
+    return n;
+  }
+  void clear() {
+    int expand[] = { 0, (std::get<
+      std::vector<Types> >(buckets).clear(), 0)... };
+    (void)expand;
+  }
+  // f gets each element as its concrete type;
+  // a generic lambda serves every bucket:
+  template<class F>
+  void forEach(F f) {
+    each(f, std::index_sequence_for<Types...>());
+  }
+  // For code that only knows the Base interface:
+  template<class F>
+  void forEachBase(F f) {
+    forEach([&f](Base& b) { f(b); });
+  }
+};
+#endif // POLYBUCKETS_H ///:~
@@ -0,0 +1,86 @@
+//: C16:PolyBucketsBench.cpp
+// vector<Shape*> vs. type-bucketed storage
+#include "PolyBuckets.h"
+#include "../bench.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+using namespace std;
+
+// Quiet Shapes that do a little arithmetic:
+class Shape {
+public:
+  virtual double area() const = 0;
+  virtual ~Shape() {}
+};
+
+class Circle final : public Shape {
+  double r;
+public:
+  Circle(double rr) : r(rr) {}
+  double area() const { return 3.14159 * r * r; }
+};
+
+class Square final : public Shape {
+  double s;
+public:
+  Square(double ss) : s(ss) {}
+  double area() const { return s * s; }
+};
+
+class Line final : public Shape {
+public:
+  Line(double) {}
+  double area() const { return 0; }
+};
+
+int main(int argc, char* argv[]) {
+  long n = benchArg(argc, argv, 1, 10000000);
+  mt19937 rng(47);
+  // The usual layout: individually new'd
+  // objects in random type order:
+  vector<Shape*> ptrs;
+  PolyBuckets<Shape, Circle, Square, Line> pb;
+  for(long i = 0; i < n; i++) {
+    double size = 1 + i % 7;
+    switch(rng() % 3) {
+      case 0: ptrs.push_back(new Circle(size));
+        pb.emplace<Circle>(size); break;
+      case 1: ptrs.push_back(new Square(size));
+        pb.emplace<Square>(size); break;
+      case 2: ptrs.push_back(new Line(size));
+        pb.emplace<Line>(size); break;
+    }
+  }
+  for(int rep = 0; rep < 3; rep++) {
+    Timer t;
+    double total = 0;
+    for(size_t i = 0; i < ptrs.size(); i++)
+      total += ptrs[i]->area();
+    report("vector<Shape*>, virtual", 
+      t.seconds(), n);
+    keep(total);
+    t.reset();
+    double total2 = 0;
+    pb.forEachBase([&total2](Shape& s) { 
+      total2 += s.area(); });
+    report("buckets, virtual per element", 
+      t.seconds(), n);
+    keep(total2);
+    t.reset();
+    double total3 = 0;
+    pb.forEach([&total3](auto& s) { 
+      total3 += s.area(); }); // final: direct
+    report("buckets, bound per batch", 
+      t.seconds(), n);
+    keep(total3);
+    // Summation order differs, so allow rounding:
+    if(fabs(total - total2) > 1e-9 * total ||
+       fabs(total - total3) > 1e-9 * total)
+      printf("results differ!\n");
+  }
+  for(size_t i = 0; i < ptrs.size(); i++)
+    delete ptrs[i];
+} ///:~
@@ -0,0 +1,34 @@
+//: C16:PolyBucketsTest.cpp
+// Shapes drawn one type-batch at a time
+#include "PolyBuckets.h"
+#include "Shape.h"
+#include "../require.h"
+#include <iostream>
+using namespace std;
+
+typedef PolyBuckets<Shape, Circle, Square, Line> 
+  Drawing;
+
+int main() {
+  Drawing d;
+  // Reserving avoids moves (and ~Shape output):
+  d.reserve<Circle>(2);
+  d.reserve<Square>(1);
+  d.reserve<Line>(2);
+  d.emplace<Line>();
+  d.emplace<Circle>();
+  d.emplace<Square>();
+  d.emplace<Circle>();
+  d.emplace<Line>();
+  require(d.size() == 5, "size()");
+  require(d.bucket<Circle>().size() == 2);
+  cout << "Bound statically, per type:" << endl;
+  d.forEach([](auto& s) {
+    typedef typename 
+      std::decay<decltype(s)>::type S;
+    s.S::draw(); // Qualified: no vtable lookup
+  });
+  cout << "Through the Shape interface:" << endl;
+  d.forEachBase([](Shape& s) { s.erase(); });
+  cout << "Destroying:" << endl;
+} ///:~
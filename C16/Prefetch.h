@@ -0,0 +1,16 @@
+//: C16:Prefetch.h
+// Portable software prefetch hint
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+// A hint only: never faults, even on a null or
+// dangling pointer, and compiles to nothing
+// where the compiler has no builtin:
+inline void prefetch(const void* p) {
+#if defined(__GNUC__)
+  __builtin_prefetch(p, 0, 3);
+#else
+  (void)p;
+#endif
+}
+#endif // PREFETCH_H ///:~
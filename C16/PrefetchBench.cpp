@@ -0,0 +1,68 @@
+//: C16:PrefetchBench.cpp
+// Cold-cache walk of a long Stack
+#include "TStack2.h"
+#include "../bench.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+using namespace std;
+
+struct Payload {
+  long value;
+  char fill[24];
+  Payload(long v) : value(v) {}
+};
+
+// Stream through a buffer bigger than the
+// last-level cache to evict the Stack:
+void flushCache() {
+  static vector<char> junk(256 << 20);
+  for(size_t i = 0; i < junk.size(); i += 64)
+    junk[i]++;
+  keep(junk[0]);
+}
+
+int main(int argc, char* argv[]) {
+  long n = benchArg(argc, argv, 1, 10000000);
+  // Scatter the elements: allocate them, then
+  // push in shuffled order. Interleaved junk
+  // allocations spread the Links out too:
+  vector<Payload*> elems;
+  for(long i = 0; i < n; i++)
+    elems.push_back(new Payload(i));
+  shuffle(elems.begin(), elems.end(), 
+    mt19937(47));
+  Stack<Payload> s;
+  vector<char*> gaps;
+  for(long i = 0; i < n; i++) {
+    s.push(elems[i]);
+    gaps.push_back(new char[48]);
+  }
+  for(long i = 0; i < n; i++)
+    delete []gaps[i];
+  long expect = n * (n - 1) / 2;
+  flushCache();
+  Timer t;
+  long sum = 0;
+  for(Stack<Payload>::iterator it = s.begin();
+      it != s.end(); it++)
+    sum += it->value;
+  double plain = t.seconds();
+  if(sum != expect) printf("plain: bad sum\n");
+  report("plain iterator", plain, n);
+  int distances[] = { 2, 4, 8, 16, 32 };
+  for(int d = 0; d < 5; d++) {
+    flushCache();
+    t.reset();
+    sum = 0;
+    s.forEach([&sum](Payload* p) { 
+      sum += p->value; }, distances[d]);
+    double secs = t.seconds();
+    if(sum != expect) printf("forEach: bad sum\n");
+    char name[40];
+    sprintf(name, "forEach, distance %d", 
+      distances[d]);
+    report(name, secs, n);
+  }
+} ///:~
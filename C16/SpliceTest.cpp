@@ -0,0 +1,63 @@
+//: C16:SpliceTest.cpp
+// splice(), pushRange() and popN() on TStack2
+#include "../require.h"
+#include "TStack2.h"
+#include <iostream>
+#include <vector>
+using namespace std;
+
+// Throws when it reaches element fail:
+struct Failing {
+  int** p;
+  int** fail;
+  int* operator*() const {
+    if(p == fail) throw 47;
+    return *p;
+  }
+  Failing& operator++() { ++p; return *this; }
+  bool operator!=(const Failing& rv) const {
+    return p != rv.p;
+  }
+};
+
+int main() {
+  Stack<int> a, b;
+  vector<int*> v;
+  for(int i = 0; i < 10; i++)
+    v.push_back(new int(i));
+  a.pushRange(v.begin(), v.begin() + 5);
+  b.pushRange(v.begin() + 5, v.end());
+  require(*a.peek() == 4, "pushRange order");
+  // All of b goes on top of a, in O(1):
+  a.splice(b);
+  require(b.peek() == 0, "splice empties source");
+  require(*a.peek() == 9, "splice order");
+  // Splicing into an empty Stack adopts the tail:
+  b.splice(a);
+  b.push(new int(10));
+  int* out[20];
+  int n = b.popN(20, out);
+  require(n == 11, "popN count");
+  for(int i = 0; i < n; i++) {
+    require(*out[i] == 10 - i, "popN order");
+    cout << *out[i] << ' ';
+    delete out[i];
+  }
+  cout << endl;
+  // The emptied Stack is fully reusable:
+  b.push(new int(47));
+  a.splice(b);
+  cout << *a.peek() << endl;
+  // A throw partway leaves the Stack as it was:
+  int* top = a.peek();
+  bool threw = false;
+  try {
+    Failing f = { &v[0], &v[3] },
+      e = { &v[0] + 5, 0 };
+    a.pushRange(f, e);
+  } catch(int) {
+    threw = true;
+  }
+  require(threw && a.peek() == top,
+    "Partial pushRange");
+} ///:~
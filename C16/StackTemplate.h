@@ -6,9 +6,9 @@
 // Simple stack template
 #ifndef STACKTEMPLATE_H
 #define STACKTEMPLATE_H
-#include "../require.h"
+#include "BoundsCheck.h"
 
-template<class T>
+template<class T, class Bounds = DefaultBounds>
 class StackTemplate {
   enum { ssize = 100 };
   T stack[ssize];
@@ -16,11 +16,12 @@ class StackTemplate {
 public:
   StackTemplate() : top(0) {}
   void push(const T& i) {
-    require(top < ssize, "Too many push()es");
+    Bounds::check(top < ssize,
+      "Too many push()es");
     stack[top++] = i;
   }
   T pop() {
-    require(top > 0, "Too many pop()s");
+    Bounds::check(top > 0, "Too many pop()s");
     return stack[--top];
   }
   int size() { return top; }
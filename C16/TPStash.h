@@ -5,8 +5,11 @@
 // Copyright notice in Copyright.txt
 #ifndef TPSTASH_H
 #define TPSTASH_H
+#include "BoundsCheck.h"
+#include <cstring>
 
-template<class T, int incr = 10>
+template<class T, int incr = 10, 
+  class Bounds = DefaultBounds>
 class PStash {
   int quantity; // Number of storage spaces
   int next; // Next empty space
@@ -23,8 +26,8 @@ public:
   int count() const { return next; }
 };
 
-template<class T, int incr>
-int PStash<T, incr>::add(T* element) {
+template<class T, int incr, class Bounds>
+int PStash<T, incr, Bounds>::add(T* element) {
   if(next >= quantity)
     inflate(incr);
   storage[next++] = element;
@@ -32,8 +35,8 @@ int PStash<T, incr>::add(T* element) {
 }
 
 // Ownership of remaining pointers:
-template<class T, int incr>
-PStash<T, incr>::~PStash() {
+template<class T, int incr, class Bounds>
+PStash<T, incr, Bounds>::~PStash() {
   for(int i = 0; i < next; i++) {
     delete storage[i]; // Null pointers OK
     storage[i] = 0; // Just to be safe
@@ -41,20 +44,21 @@ PStash<T, incr>::~PStash() {
   delete []storage;
 }
 
-template<class T, int incr>
-T* PStash<T, incr>::operator[](int index) const {
-  require(index >= 0,
+template<class T, int incr, class Bounds>
+T* PStash<T, incr, Bounds>::operator[](
+  int index) const {
+  Bounds::check(index >= 0,
     "PStash::operator[] index negative");
   if(index >= next)
     return 0; // To indicate the end
-  require(storage[index] != 0, 
+  Bounds::check(storage[index] != 0, 
     "PStash::operator[] returned null pointer");
   // Produce pointer to desired element:
   return storage[index];
 }
 
-template<class T, int incr>
-T* PStash<T, incr>::remove(int index) {
+template<class T, int incr, class Bounds>
+T* PStash<T, incr, Bounds>::remove(int index) {
   // operator[] performs validity checks:
   T* v = operator[](index);
   // "Remove" the pointer:
@@ -62,8 +66,9 @@ T* PStash<T, incr>::remove(int index) {
   return v;
 }
 
-template<class T, int incr>
-void PStash<T, incr>::inflate(int increase) {
+template<class T, int incr, class Bounds>
+void PStash<T, incr, Bounds>::inflate(
+  int increase) {
   const int psz = sizeof(T*);
   T** st = new T*[quantity + increase];
   memset(st, 0, (quantity + increase) * psz);
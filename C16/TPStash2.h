@@ -7,10 +7,18 @@
 #ifndef TPSTASH2_H
 #define TPSTASH2_H
 #include "../require.h"
+#include "BoundsCheck.h"
+#include "ContainerStats.h"
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
 
-template<class T, int incr = 20>
-class PStash {
+template<class T, int incr = 20, 
+  class Stats = NoStats, 
+  class Bounds = DefaultBounds>
+class PStash : private Stats {
   int quantity;
   int next;
   T** storage;
@@ -22,95 +30,164 @@ public:
   T* operator[](int index) const;
   T* remove(int index);
   int count() const { return next; }
-  // Nested iterator class:
-  class iterator; // Declaration required
-  friend class iterator; // Make it a friend
-  class iterator { // Now define it
-    PStash& ps;
+  const Stats& stats() const { return *this; }
+  // Nested random-access iterator. iterator
+  // refers to T*&, const_iterator to T* const&:
+  template<class Ref, class Owner> class Iter;
+  template<class Ref, class Owner> 
+  friend class Iter;
+  template<class Ref, class Owner> class Iter {
+    Owner* ps; // Pointer, so Iters can assign
     int index;
+    template<class R, class O> friend class Iter;
   public:
-    iterator(PStash& pStash)
-      : ps(pStash), index(0) {}
+    typedef std::random_access_iterator_tag 
+      iterator_category;
+    typedef T* value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef typename 
+      std::remove_reference<Ref>::type* pointer;
+    typedef Ref reference;
+    Iter() : ps(0), index(0) {}
+    Iter(Owner& pStash)
+      : ps(&pStash), index(0) {}
     // To create the end sentinel:
-    iterator(PStash& pStash, bool)
-      : ps(pStash), index(ps.next) {}
-    // Copy-constructor:
-    iterator(const iterator& rv)
+    Iter(Owner& pStash, bool)
+      : ps(&pStash), index(pStash.next) {}
+    Iter(const Iter&) = default;
+    Iter& operator=(const Iter&) = default;
+    // iterator converts to const_iterator. A
+    // template, so it isn't also the copy
+    // constructor of iterator:
+    template<class R, class = typename
+      std::enable_if<std::is_same<R, T*&>::value
+      >::type>
+    Iter(const Iter<R, PStash>& rv)
       : ps(rv.ps), index(rv.index) {}
-    iterator& operator=(const iterator& rv) {
-      ps = rv.ps;
-      index = rv.index;
-      return *this;
-    }
-    iterator& operator++() {
-      require(++index <= ps.next,
+    Iter& operator++() {
+      Bounds::check(++index <= ps->next,
         "PStash::iterator::operator++ "
         "moves index out of bounds");
       return *this;
     }
-    iterator& operator++(int) {
-      return operator++();
+    Iter operator++(int) {
+      Iter old(*this);
+      operator++();
+      return old;
     }
-    iterator& operator--() {
-      require(--index >= 0,
+    Iter& operator--() {
+      Bounds::check(--index >= 0,
         "PStash::iterator::operator-- "
         "moves index out of bounds");
       return *this;
     }
-    iterator& operator--(int) { 
-      return operator--();
+    Iter operator--(int) { 
+      Iter old(*this);
+      operator--();
+      return old;
     }
-    // Jump interator forward or backward:
-    iterator& operator+=(int amount) {
-      require(index + amount < ps.next && 
-        index + amount >= 0, 
+    // Jump interator forward or backward. The
+    // end position is a valid target:
+    Iter& operator+=(difference_type amount) {
+      Bounds::check(
+        index + amount <= ps->next &&
+        index + amount >= 0,
         "PStash::iterator::operator+= "
         "attempt to index out of bounds");
       index += amount;
       return *this;
     }
-    iterator& operator-=(int amount) {
-      require(index - amount < ps.next && 
-        index - amount >= 0, 
-        "PStash::iterator::operator-= "
-        "attempt to index out of bounds");
-      index -= amount;
-      return *this;
+    Iter& operator-=(difference_type amount) {
+      return *this += -amount;
     }
     // Create a new iterator that's moved forward
-    iterator operator+(int amount) const {
-      iterator ret(*this);
+    Iter operator+(
+      difference_type amount) const {
+      Iter ret(*this);
       ret += amount; // op+= does bounds check
       return ret;
     }
+    friend Iter operator+(difference_type amount,
+      const Iter& it) { return it + amount; }
+    Iter operator-(
+      difference_type amount) const {
+      Iter ret(*this);
+      ret -= amount;
+      return ret;
+    }
+    template<class R, class O>
+    difference_type operator-(
+      const Iter<R, O>& rv) const {
+      return index - rv.index;
+    }
+    reference operator[](
+      difference_type n) const {
+      return *(*this + n);
+    }
     T* current() const {
-      return ps.storage[index];
+      ps->stats().fetched();
+      return ps->storage[index];
+    }
+    reference operator*() const { 
+      ps->stats().fetched();
+      return ps->storage[index]; 
     }
-    T* operator*() const { return current(); }
     T* operator->() const { 
-      require(ps.storage[index] != 0, 
+      Bounds::check(ps->storage[index] != 0, 
         "PStash::iterator::operator->returns 0");
       return current(); 
     }
     // Remove the current element:
     T* remove(){
-      return ps.remove(index);
+      return ps->remove(index);
     }
-    // Comparison tests for end:
-    bool operator==(const iterator& rv) const {
+    // Comparison tests for end, and ordering:
+    template<class R, class O>
+    bool operator==(const Iter<R, O>& rv) const {
       return index == rv.index;
     }
-    bool operator!=(const iterator& rv) const {
+    template<class R, class O>
+    bool operator!=(const Iter<R, O>& rv) const {
       return index != rv.index;
     }
+    template<class R, class O>
+    bool operator<(const Iter<R, O>& rv) const {
+      return index < rv.index;
+    }
+    template<class R, class O>
+    bool operator>(const Iter<R, O>& rv) const {
+      return index > rv.index;
+    }
+    template<class R, class O>
+    bool operator<=(const Iter<R, O>& rv) const {
+      return index <= rv.index;
+    }
+    template<class R, class O>
+    bool operator>=(const Iter<R, O>& rv) const {
+      return index >= rv.index;
+    }
   };
+  typedef Iter<T*&, PStash> iterator;
+  typedef Iter<T* const&, const PStash> 
+    const_iterator;
   iterator begin() { return iterator(*this); }
   iterator end() { return iterator(*this, true);}
+  const_iterator begin() const { 
+    return const_iterator(*this); 
+  }
+  const_iterator end() const { 
+    return const_iterator(*this, true);
+  }
+  const_iterator cbegin() const {
+    return begin();
+  }
+  const_iterator cend() const { return end(); }
 };
 
 // Destruction of contained objects:
-template<class T, int incr>
-PStash<T, incr>::~PStash() {
+template<class T, int incr, class Stats, 
+  class Bounds>
+PStash<T, incr, Stats, Bounds>::~PStash() {
   for(int i = 0; i < next; i++) {
     delete storage[i]; // Null pointers OK
     storage[i] = 0; // Just to be safe
@@ -118,40 +195,53 @@ PStash<T, incr>::~PStash() {
   delete []storage;
 }
 
-template<class T, int incr>
-int PStash<T, incr>::add(T* element) {
+template<class T, int incr, class Stats, 
+  class Bounds>
+int PStash<T, incr, Stats, Bounds>::add(
+  T* element) {
   if(next >= quantity)
     inflate();
   storage[next++] = element;
+  Stats::added();
   return(next - 1); // Index number
 }
 
-template<class T, int incr> inline
-T* PStash<T, incr>::operator[](int index) const {
-  require(index >= 0,
+template<class T, int incr, class Stats, 
+  class Bounds> inline
+T* PStash<T, incr, Stats, Bounds>::operator[](
+  int index) const {
+  Stats::fetched();
+  Bounds::check(index >= 0,
     "PStash::operator[] index negative");
   if(index >= next)
     return 0; // To indicate the end
-  require(storage[index] != 0, 
+  Bounds::check(storage[index] != 0, 
     "PStash::operator[] returned null pointer");
   return storage[index];
 }
 
-template<class T, int incr>
-T* PStash<T, incr>::remove(int index) {
+template<class T, int incr, class Stats, 
+  class Bounds>
+T* PStash<T, incr, Stats, Bounds>::remove(
+  int index) {
   // operator[] performs validity checks:
   T* v = operator[](index);
   // "Remove" the pointer:
+  if(v != 0) Stats::removed();
   storage[index] = 0;
   return v;
 }
 
-template<class T, int incr>
-void PStash<T, incr>::inflate(int increase) {
+template<class T, int incr, class Stats, 
+  class Bounds>
+void PStash<T, incr, Stats, Bounds>::inflate(
+  int increase) {
   const int tsz = sizeof(T*);
   T** st = new T*[quantity + increase];
   memset(st, 0, (quantity + increase) * tsz);
   memcpy(st, storage, quantity * tsz);
+  Stats::inflated(quantity + increase, 
+    quantity * tsz);
   quantity += increase;
   delete []storage; // Old storage
   storage = st; // Point to new memory
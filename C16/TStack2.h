@@ -6,43 +6,83 @@
 // Templatized Stack with nested iterator
 #ifndef TSTACK2_H
 #define TSTACK2_H
+#include "../require.h"
+#include "ContainerStats.h"
+#include "Prefetch.h"
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
 
-template<class T> class Stack {
+template<class T, class Stats = NoStats> 
+class Stack : private Stats {
   struct Link {
     T* data;
     Link* next;
     Link(T* dat, Link* nxt)
       : data(dat), next(nxt) {}
   }* head;
+  Link* tail; // Bottom Link, so splice() is O(1)
 public:
-  Stack() : head(0) {}
+  Stack() : head(0), tail(0) {}
   ~Stack();
   void push(T* dat) {
     head = new Link(dat, head);
+    if(!tail) tail = head;
+    Stats::linkAllocated();
+    Stats::added();
   }
   T* peek() const { 
+    Stats::fetched();
     return head ? head->data : 0;
   }
   T* pop();
-  // Nested iterator class:
-  class iterator; // Declaration required
-  friend class iterator; // Make it a friend
-  class iterator { // Now define it
+  // Move all of other's elements onto the top
+  // of this Stack, keeping their order:
+  void splice(Stack& other);
+  // Push a range; *(last - 1) ends up on top:
+  template<class InIter>
+  void pushRange(InIter first, InIter last);
+  // Pop up to n elements into out, top first.
+  // Returns the number actually popped:
+  template<class OutIter>
+  int popN(int n, OutIter out);
+  const Stats& stats() const { return *this; }
+  // Nested forward iterator. Ref is T*& for
+  // iterator and T* const& for const_iterator:
+  template<class Ref> class Iter;
+  template<class Ref> friend class Iter;
+  template<class Ref> class Iter {
     Stack::Link* p;
+    template<class R> friend class Iter;
   public:
-    iterator(const Stack<T>& tl) : p(tl.head) {}
-    // Copy-constructor:
-    iterator(const iterator& tl) : p(tl.p) {}
+    typedef std::forward_iterator_tag 
+      iterator_category;
+    typedef T* value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef typename 
+      std::remove_reference<Ref>::type* pointer;
+    typedef Ref reference;
+    Iter(const Stack& tl) : p(tl.head) {}
     // The end sentinel iterator:
-    iterator() : p(0) {}
-    // operator++ returns boolean indicating end:
-    bool operator++() {
-      if(p->next)
-        p = p->next;
-      else p = 0; // Indicates end of list
-      return bool(p);
+    Iter() : p(0) {}
+    Iter(const Iter&) = default;
+    Iter& operator=(const Iter&) = default;
+    // iterator converts to const_iterator. A
+    // template, so it isn't also the copy
+    // constructor of iterator:
+    template<class R, class = typename
+      std::enable_if<std::is_same<R, T*&>::value
+      >::type>
+    Iter(const Iter<R>& rv) : p(rv.p) {}
+    Iter& operator++() {
+      p = p->next; // Null at the end of list
+      return *this;
+    }
+    Iter operator++(int) {
+      Iter old(*this);
+      p = p->next;
+      return old;
     }
-    bool operator++(int) { return operator++(); }
     T* current() const {
       if(!p) return 0;
       return p->data;
@@ -53,34 +93,156 @@ public:
         "PStack::iterator::operator->returns 0");
       return current(); 
     }
-    T* operator*() const { return current(); }
+    reference operator*() const {
+      return p->data;
+    }
     // bool conversion for conditional test:
     operator bool() const { return bool(p); }
     // Comparison to test for end:
-    bool operator==(const iterator&) const {
-      return p == 0;
+    template<class R>
+    bool operator==(const Iter<R>& rv) const {
+      return p == rv.p;
+    }
+    template<class R>
+    bool operator!=(const Iter<R>& rv) const {
+      return p != rv.p;
+    }
+  };
+  typedef Iter<T*&> iterator;
+  typedef Iter<T* const&> const_iterator;
+  iterator begin() { return iterator(*this); }
+  iterator end() { return iterator(); }
+  const_iterator begin() const { 
+    return const_iterator(*this); 
+  }
+  const_iterator end() const { 
+    return const_iterator(); 
+  }
+  const_iterator cbegin() const {
+    return begin();
+  }
+  const_iterator cend() const { return end(); }
+  // Traversal mode for long, cold Stacks: a lead
+  // pointer runs distance Links ahead and 
+  // prefetches each Link and its element, so
+  // those loads overlap instead of stalling one
+  // after another:
+  class prefetch_iterator {
+    Stack::Link* p;
+    Stack::Link* lead;
+    void advanceLead() {
+      lead = lead->next;
+      if(lead) {
+        prefetch(lead->next);
+        prefetch(lead->data);
+      }
+    }
+  public:
+    prefetch_iterator(const Stack& tl, 
+      int distance = 8) : p(tl.head), lead(p) {
+      for(int i = 0; i < distance && lead; i++)
+        advanceLead();
     }
-    bool operator!=(const iterator&) const {
-      return p != 0;
+    prefetch_iterator& operator++() {
+      p = p->next;
+      if(lead) advanceLead();
+      return *this;
     }
+    T* operator*() const { return p->data; }
+    T* operator->() const { return p->data; }
+    operator bool() const { return p != 0; }
   };
-  iterator begin() const { 
-    return iterator(*this); 
+  prefetch_iterator prefetchBegin(
+    int distance = 8) const {
+    return prefetch_iterator(*this, distance);
+  }
+  // Apply f to every element, top first:
+  template<class F>
+  void forEach(F f, int distance = 8) const {
+    for(prefetch_iterator it(*this, distance);
+        it; ++it)
+      f(*it);
   }
-  iterator end() const { return iterator(); }
 };
 
-template<class T> Stack<T>::~Stack() {
+template<class T, class Stats> 
+Stack<T, Stats>::~Stack() {
   while(head)
     delete pop();
 }
 
-template<class T> T* Stack<T>::pop() {
+template<class T, class Stats> 
+T* Stack<T, Stats>::pop() {
   if(head == 0) return 0;
   T* result = head->data;
   Link* oldHead = head;
   head = head->next;
+  if(head == 0) tail = 0;
   delete oldHead;
+  Stats::linkFreed();
+  Stats::removed();
   return result;
 }
+
+template<class T, class Stats>
+void Stack<T, Stats>::splice(Stack& other) {
+  if(&other == this || other.head == 0) return;
+  // Relink the whole chain in one step:
+  other.tail->next = head;
+  if(tail == 0) tail = other.tail;
+  head = other.head;
+  other.head = other.tail = 0;
+  Stats::splicedFrom(other.stats());
+}
+
+template<class T, class Stats> 
+template<class InIter>
+void Stack<T, Stats>::pushRange(InIter first, 
+  InIter last) {
+  // Build the new chain off to the side, then
+  // attach it with a single head update. If
+  // the iterator or new throws, the partial
+  // chain is freed and the Stack is unchanged:
+  Link* top = 0;
+  Link* bottom = 0;
+  long n = 0;
+  try {
+    for(; first != last; ++first, n++) {
+      top = new Link(*first, top);
+      if(!bottom) bottom = top;
+    }
+  } catch(...) {
+    while(top) {
+      Link* next = top->next;
+      delete top;
+      top = next;
+    }
+    throw;
+  }
+  if(!top) return;
+  Stats::linkAllocated(n);
+  Stats::added(n);
+  bottom->next = head;
+  if(tail == 0) tail = bottom;
+  head = top;
+}
+
+template<class T, class Stats> 
+template<class OutIter>
+int Stack<T, Stats>::popN(int n, OutIter out) {
+  int popped = 0;
+  Link* p = head;
+  while(p && popped < n) {
+    *out++ = p->data;
+    Link* old = p;
+    p = p->next;
+    delete old;
+    popped++;
+  }
+  head = p;
+  if(head == 0) tail = 0;
+  Stats::linkFreed(popped);
+  Stats::removed(popped);
+  return popped;
+}
 #endif // TSTACK2_H ///:~
@@ -0,0 +1,120 @@
+//: C16:ThreadPool.h
+// Fixed set of worker threads sharing a queue
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+  std::vector<std::thread> workers;
+  std::deque<std::function<void()> > tasks;
+  std::mutex m;
+  std::condition_variable ready;
+  bool stopping;
+  void work() {
+    for(;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(m);
+        ready.wait(lock, [this] { 
+          return stopping || !tasks.empty(); });
+        if(tasks.empty()) return; // Stopping
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      task();
+    }
+  }
+  // State for one run(); shared, so helpers
+  // that start late never touch a dead frame:
+  template<class F> struct Run {
+    F f;
+    std::size_t n;
+    std::atomic<std::size_t> next, done;
+    std::mutex m;
+    std::condition_variable finished;
+    std::exception_ptr error;
+    Run(F fn, std::size_t count) 
+      : f(fn), n(count), next(0), done(0) {}
+    // Claim chunks until there are none left:
+    void help() {
+      std::size_t i;
+      while((i = next++) < n) {
+        try {
+          f(i);
+        } catch(...) {
+          std::lock_guard<std::mutex> lock(m);
+          if(!error) 
+            error = std::current_exception();
+        }
+        if(++done == n) {
+          std::lock_guard<std::mutex> lock(m);
+          finished.notify_all();
+        }
+      }
+    }
+  };
+  ThreadPool(const ThreadPool&);
+  void operator=(const ThreadPool&);
+public:
+  explicit ThreadPool(unsigned threads = 
+    std::thread::hardware_concurrency())
+    : stopping(false) {
+    if(threads == 0) threads = 1;
+    for(unsigned i = 0; i < threads; i++)
+      workers.push_back(
+        std::thread(&ThreadPool::work, this));
+  }
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      stopping = true;
+    }
+    ready.notify_all();
+    for(std::size_t i = 0; i < workers.size(); i++)
+      workers[i].join();
+  }
+  unsigned size() const { return workers.size(); }
+  void submit(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      tasks.push_back(std::move(task));
+    }
+    ready.notify_one();
+  }
+  // Call f(0) ... f(n - 1) across the pool and
+  // wait for all of them. The calling thread
+  // helps, so a nested run() can't deadlock.
+  // The first exception thrown is rethrown:
+  template<class F>
+  void run(std::size_t n, F f) {
+    if(n == 0) return;
+    std::shared_ptr<Run<F> > r(new Run<F>(f, n));
+    std::size_t helpers = 
+      n - 1 < size() ? n - 1 : size();
+    for(std::size_t i = 0; i < helpers; i++)
+      submit([r] { r->help(); });
+    r->help();
+    {
+      std::unique_lock<std::mutex> lock(r->m);
+      r->finished.wait(lock, [&r] { 
+        return r->done == r->n; });
+    }
+    if(r->error) 
+      std::rethrow_exception(r->error);
+  }
+  // One shared pool for the whole program:
+  static ThreadPool& instance() {
+    static ThreadPool pool;
+    return pool;
+  }
+};
+#endif // THREADPOOL_H ///:~
@@ -6,9 +6,11 @@
 // Holding objects by value in a Stack
 #ifndef VALUESTACK_H
 #define VALUESTACK_H
-#include "../require.h"
+#include "BoundsCheck.h"
+#include <utility>
 
-template<class T, int ssize = 100>
+template<class T, int ssize = 100, 
+  class Bounds = DefaultBounds>
 class Stack {
   // Default constructor performs object
   // initialization for each element in array:
@@ -18,15 +20,21 @@ public:
   Stack() : top(0) {}
   // Copy-constructor copies object into array:
   void push(const T& x) {
-    require(top < ssize, "Too many push()es");
+    Bounds::check(top < ssize, "Too many push()es");
     stack[top++] = x;
   }
+  // A temporary is moved in, not copied:
+  void push(T&& x) {
+    Bounds::check(top < ssize, "Too many push()es");
+    stack[top++] = std::move(x);
+  }
   T peek() const { return stack[top]; }
   // Object still exists when you pop it; 
-  // it just isn't available anymore:
+  // it just isn't available anymore, so its
+  // contents are moved out:
   T pop() {
-    require(top > 0, "Too many pop()s");
-    return stack[--top];
+    Bounds::check(top > 0, "Too many pop()s");
+    return std::move(stack[--top]);
   }
 };
 #endif // VALUESTACK_H ///:~
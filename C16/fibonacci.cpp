@@ -3,20 +3,53 @@
 // Available at http://www.BruceEckel.com
 // (c) Bruce Eckel 2000
 // Copyright notice in Copyright.txt
+#include "fibonacci.h"
 #include "../require.h"
 
 int fibonacci(int n) {
-  const int sz = 100;
-  require(n < sz);
-  static int f[sz]; // Initialized to zero
-  f[0] = f[1] = 1;
-  // Scan for unfilled array elements:
-  int i;
-  for(i = 0; i < sz; i++)
-    if(f[i] == 0) break;
-  while(i <= n) {
-    f[i] = f[i-1] + f[i-2];
-    i++;
+  require(n >= 0 && n <= 45, 
+    "fibonacci() argument out of range");
+  return int(fibonacci64(n));
+}
+
+// Fast doubling works on the standard sequence,
+// F(0) == 0 and F(1) == 1, which is ours shifted
+// by one: fibonacci(n) == F(n + 1). With
+// a = F(k) and b = F(k + 1):
+//   F(2k)     = a * (2b - a)
+//   F(2k + 1) = a * a + b * b
+template<class Num>
+static Num fastDoubling(unsigned long m) {
+  Num a = 0, b = 1;
+  int bit = 0;
+  while((m >> bit) > 1) bit++;
+  for(; bit >= 0; bit--) {
+    Num c = a * (b + b - a);
+    Num d = a * a + b * b;
+    if((m >> bit) & 1) {
+      a = d;
+      b = c + d;
+    } else {
+      a = c;
+      b = d;
+    }
   }
-  return f[n];
+  return a;
+}
+
+#if defined(__SIZEOF_INT128__)
+unsigned __int128 fibonacci128(int n) {
+  require(n >= 0 && n <= 184, 
+    "fibonacci128() argument out of range");
+  if(n < fibonacciDetail::tableSize)
+    return fibonacci64(n);
+  return fastDoubling<unsigned __int128>(n + 1);
+}
+#endif
+
+BigUnsigned bigFibonacci(long n) {
+  require(n >= 0, "bigFibonacci() of negative");
+  if(n < fibonacciDetail::tableSize)
+    return BigUnsigned(fibonacci64(n));
+  return fastDoubling<BigUnsigned>(n + 1);
 } ///:~
@@ -4,4 +4,48 @@
 // (c) Bruce Eckel 2000
 // Copyright notice in Copyright.txt
 // Fibonacci number generator
-int fibonacci(int n); ///:~
+#ifndef FIBONACCI_H
+#define FIBONACCI_H
+#include "BigUnsigned.h"
+#include "../require.h"
+#include <cstdint>
+
+// All of these count from fibonacci(0) == 1,
+// fibonacci(1) == 1, fibonacci(2) == 2, ...
+// None keeps mutable state, so all are
+// thread-safe.
+
+// Fits in an int up to n == 45:
+int fibonacci(int n);
+
+namespace fibonacciDetail {
+// F(92) is the last that fits in 64 bits:
+const int tableSize = 93;
+struct Table {
+  std::uint64_t f[tableSize];
+  constexpr Table() : f() {
+    f[0] = f[1] = 1;
+    for(int i = 2; i < tableSize; i++)
+      f[i] = f[i - 1] + f[i - 2];
+  }
+};
+constexpr Table table;
+}
+
+// Compile-time table lookup, up to n == 92:
+constexpr std::uint64_t fibonacci64(int n) {
+  return n >= 0 && n < fibonacciDetail::tableSize
+    ? fibonacciDetail::table.f[n]
+    : (requireFailed("fibonacci64() "
+        "argument out of range"), 0);
+}
+
+#if defined(__SIZEOF_INT128__)
+// Fast doubling, up to n == 184:
+unsigned __int128 fibonacci128(int n);
+#endif
+
+// Fast doubling with arbitrary precision:
+// O(log n) steps, each one a big multiply:
+BigUnsigned bigFibonacci(long n);
+#endif // FIBONACCI_H ///:~
@@ -0,0 +1,85 @@
+//: Stack:SpillStack.cpp {O}
+// Bounded memory, older Chunks on disk
+#include "SpillStack.h"
+#include "../require.h"
+#include <cstring>
+using namespace std;
+
+typedef unsigned int Length;
+
+SpillStack::SpillStack(size_t cb, int mc)
+  : chunkBytes(cb), maxChunks(mc), file(0),
+    fileEnd(0), quantity(0) {
+  require(maxChunks >= 2, 
+    "SpillStack needs at least 2 Chunks");
+}
+
+SpillStack::~SpillStack() {
+  if(file) fclose(file); // Removes the file
+}
+
+void SpillStack::push(const string& s) {
+  if(chunks.empty() || chunks.back().size() 
+      + s.size() + sizeof(Length) > chunkBytes) {
+    // Start a new Chunk:
+    chunks.push_back(Chunk());
+    chunks.back().reserve(
+      max(chunkBytes, s.size() + sizeof(Length)));
+    if(int(chunks.size()) > maxChunks)
+      spill();
+  }
+  Chunk& c = chunks.back();
+  Length len = s.size();
+  c.insert(c.end(), s.begin(), s.end());
+  const char* lp = (const char*)&len;
+  c.insert(c.end(), lp, lp + sizeof(len));
+  quantity++;
+}
+
+bool SpillStack::pop(string& s) {
+  if(quantity == 0) return false;
+  if(chunks.empty())
+    reload();
+  Chunk& c = chunks.back();
+  Length len;
+  memcpy(&len, &c[c.size() - sizeof(len)], 
+    sizeof(len));
+  size_t start = c.size() - sizeof(len) - len;
+  s.assign(&c[0] + start, len);
+  c.resize(start);
+  if(c.empty())
+    chunks.pop_back();
+  quantity--;
+  return true;
+}
+
+// Write the oldest in-memory Chunk after every
+// Chunk already on disk:
+void SpillStack::spill() {
+  if(!file) {
+    file = tmpfile();
+    require(file != 0, 
+      "SpillStack: can't create temp file");
+  }
+  Chunk& c = chunks.front();
+  require(fseek(file, fileEnd, SEEK_SET) == 0 &&
+    fwrite(&c[0], 1, c.size(), file) == c.size(),
+    "SpillStack: write to temp file failed");
+  fileEnd += c.size();
+  blockSizes.push_back(c.size());
+  chunks.pop_front();
+}
+
+// Read the newest block back from disk:
+void SpillStack::reload() {
+  require(!blockSizes.empty(), 
+    "SpillStack: nothing to reload");
+  long sz = blockSizes.back();
+  blockSizes.pop_back();
+  fileEnd -= sz;
+  chunks.push_back(Chunk(sz));
+  require(fseek(file, fileEnd, SEEK_SET) == 0 &&
+    fread(&chunks.back()[0], 1, sz, file) == 
+      size_t(sz),
+    "SpillStack: read from temp file failed");
+} ///:~
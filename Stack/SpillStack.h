@@ -0,0 +1,42 @@
+//: Stack:SpillStack.h
+// Stack of strings that spills to a temp file
+#ifndef SPILLSTACK_H
+#define SPILLSTACK_H
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+class SpillStack {
+  // Lines are packed into Chunks, each record
+  // stored as the bytes followed by their length
+  // so the top record can be found from the end:
+  typedef std::vector<char> Chunk;
+  std::deque<Chunk> chunks; // back() is the top
+  std::size_t chunkBytes;
+  int maxChunks; // Chunks kept in memory
+  // Older Chunks live in the file as a stack of
+  // blocks, written and read back sequentially:
+  std::FILE* file;
+  long fileEnd;
+  std::vector<long> blockSizes;
+  long quantity;
+  void spill();
+  void reload();
+public:
+  SpillStack(std::size_t chunkBytes = 1 << 20,
+    int maxChunks = 8);
+  ~SpillStack();
+  void push(const std::string& s);
+  // False when there was nothing to pop:
+  bool pop(std::string& s);
+  bool empty() const { return quantity == 0; }
+  long count() const { return quantity; }
+  // Number of Chunks currently on disk:
+  int spilled() const { return blockSizes.size(); }
+private:
+  SpillStack(const SpillStack&);
+  void operator=(const SpillStack&);
+};
+#endif // SPILLSTACK_H ///:~
@@ -0,0 +1,48 @@
+//: Stack:SpillStackTest.cpp
+//{L} SpillStack
+//{T} SpillStackTest.cpp
+// Reversing a file without holding it in memory
+#include "SpillStack.h"
+#include "../require.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+int main(int argc, char* argv[]) {
+  requireArgs(argc, 1); // File name is argument
+  ifstream in(argv[1]);
+  assure(in, argv[1]);
+  // Tiny Chunks, to force spilling:
+  SpillStack textlines(64, 2);
+  vector<string> check;
+  string line;
+  while(getline(in, line)) {
+    textlines.push(line);
+    check.push_back(line);
+  }
+  cout << textlines.count() << " lines, "
+       << textlines.spilled() 
+       << " Chunks on disk" << endl;
+  // Pop the lines and print them in reverse:
+  while(textlines.pop(line)) {
+    require(line == check.back(), 
+      "SpillStack returned the wrong line");
+    check.pop_back();
+    cout << line << endl;
+  }
+  require(check.empty(), "Lines went missing");
+  // Interleave pushes and pops across spills:
+  SpillStack ss(16, 2);
+  for(int i = 0; i < 1000; i++) {
+    ss.push(to_string(i));
+    if(i % 3 == 0) ss.pop(line);
+  }
+  string prev;
+  while(ss.pop(line)) {
+    if(!prev.empty())
+      require(stoi(line) < stoi(prev), "Order");
+    prev = line;
+  }
+} ///:~
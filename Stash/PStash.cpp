@@ -28,7 +28,7 @@ PStash::~PStash() {
 
 // Operator overloading replacement for fetch
 void* PStash::operator[](int index) const {
-  require(index >= 0,
+  REQUIRE_AT(REQUIRE_HOT, index >= 0,
     "PStash::operator[] index negative");
   if(index >= next)
     return 0; // To indicate the end
@@ -0,0 +1,69 @@
+//: Stash:RequireBench.cpp
+//{L} PStash
+// What a passing require() costs in PStash
+// access. Rebuild with -DREQUIRE_LEVEL=1 to
+// compile the per-access checks out
+#include "PStash.h"
+#include "../require.h"
+#include "../bench.h"
+#include <string>
+using namespace std;
+
+// require() as it was: a std::string is built
+// from the literal on every call:
+inline void oldRequire(bool requirement,
+  const string& msg = "Requirement failed") {
+  if(!requirement) requireFailed(msg.c_str());
+}
+
+const int sz = 10000;
+
+int main(int argc, char* argv[]) {
+  int reps = benchArg(argc, argv, 1, 2000);
+  long ops = long(reps) * sz;
+  PStash ps;
+  for(int i = 0; i < sz; i++)
+    ps.add(new int(i));
+  // The bound is read through a volatile, so
+  // the compiler can't prove the checks pass
+  // and fold them away:
+  volatile int vLimit = sz;
+  const int limit = vLimit;
+  long sum = 0;
+  Timer t;
+  for(int r = 0; r < reps; r++)
+    for(int i = 0; i < sz; i++) {
+      oldRequire(i < limit, 
+        "PStash::operator[] index too large");
+      sum += *(int*)ps[i];
+    }
+  report("string-building require", 
+    t.seconds(), ops);
+  t.reset();
+  for(int r = 0; r < reps; r++)
+    for(int i = 0; i < sz; i++) {
+      require(i < limit, 
+        "PStash::operator[] index too large");
+      sum += *(int*)ps[i];
+    }
+  report("require, cold failure path", 
+    t.seconds(), ops);
+  t.reset();
+  for(int r = 0; r < reps; r++)
+    for(int i = 0; i < sz; i++) {
+      REQUIRE_AT(REQUIRE_HOT, i < limit,
+        "PStash::operator[] index too large");
+      sum += *(int*)ps[i];
+    }
+  report("REQUIRE_AT(REQUIRE_HOT)", 
+    t.seconds(), ops);
+  t.reset();
+  for(int r = 0; r < reps; r++)
+    for(int i = 0; i < sz; i++)
+      sum += *(int*)ps[i];
+  report("PStash::operator[] alone", 
+    t.seconds(), ops);
+  keep(sum);
+  for(int i = 0; i < sz; i++)
+    delete (int*)ps.remove(i);
+} ///:~
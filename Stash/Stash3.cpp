@@ -47,7 +47,8 @@ int Stash::add(void* element) {
 }
 
 void* Stash::fetch(int index) {
-  require(0 <= index, "Stash::fetch (-)index");
+  REQUIRE_AT(REQUIRE_HOT, 0 <= index, 
+    "Stash::fetch (-)index");
   if(index >= next)
     return 0; // To indicate the end
   // Produce pointer to desired element:
@@ -28,7 +28,8 @@ public:
   }
   int add(void* element);
   void* fetch(int index) const {
-    require(0 <= index, "Stash::fetch (-)index");
+    REQUIRE_AT(REQUIRE_HOT, 0 <= index, 
+      "Stash::fetch (-)index");
     if(index >= next)
       return 0; // To indicate the end
     // Produce pointer to desired element:
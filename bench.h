@@ -0,0 +1,46 @@
+//: :bench.h
+// Timing helpers shared by the benchmarks
+#ifndef BENCH_H
+#define BENCH_H
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+class Timer {
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point start;
+public:
+  Timer() : start(Clock::now()) {}
+  void reset() { start = Clock::now(); }
+  double seconds() const {
+    return std::chrono::duration<double>(
+      Clock::now() - start).count();
+  }
+  double ms() const { return seconds() * 1e3; }
+  double ns() const { return seconds() * 1e9; }
+};
+
+// Stop the optimizer from discarding a result:
+template<class T>
+inline void keep(const T& x) {
+#if defined(__GNUC__)
+  asm volatile("" : : "g"(&x) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &x;
+#endif
+}
+
+// Optional numeric argument, e.g. element count:
+inline long benchArg(int argc, char* argv[],
+  int index, long defaultValue) {
+  return argc > index ? 
+    std::atol(argv[index]) : defaultValue;
+}
+
+inline void report(const char* name, 
+  double seconds, long ops) {
+  std::printf("%-32s %10.3f ms %8.2f ns/op\n",
+    name, seconds * 1e3, seconds * 1e9 / ops);
+}
+#endif // BENCH_H ///:~
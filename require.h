@@ -12,16 +12,55 @@
 #include <fstream>
 #include <string>
 
-inline void require(bool requirement, 
-  const std::string& msg = "Requirement failed"){
+#if defined(__GNUC__)
+#define REQUIRE_COLD __attribute__((cold, noinline))
+#define REQUIRE_LIKELY(x) __builtin_expect(!!(x), 1)
+#elif defined(_MSC_VER)
+#define REQUIRE_COLD __declspec(noinline)
+#define REQUIRE_LIKELY(x) (x)
+#else
+#define REQUIRE_COLD
+#define REQUIRE_LIKELY(x) (x)
+#endif
+
+// The failure path, kept out of line so a
+// passing check is just a compare and branch:
+REQUIRE_COLD inline void 
+requireFailed(const char* msg) {
   using namespace std;
-  if (!requirement) {
-    fputs(msg.c_str(), stderr);
-    fputs("\n", stderr);
-    exit(1);
-  }
+  fputs(msg, stderr);
+  fputs("\n", stderr);
+  exit(1);
+}
+
+// A literal message stays a char pointer; no
+// string is built unless the check fails:
+inline void require(bool requirement, 
+  const char* msg = "Requirement failed") {
+  if(!REQUIRE_LIKELY(requirement))
+    requireFailed(msg);
+}
+
+inline void require(bool requirement, 
+  const std::string& msg) {
+  if(!REQUIRE_LIKELY(requirement))
+    requireFailed(msg.c_str());
 }
 
+// Checks graded by cost. Any level above
+// REQUIRE_LEVEL compiles to nothing, without
+// evaluating its condition:
+#define REQUIRE_ALWAYS 0 // Never compiled out
+#define REQUIRE_CHEAP 1  // Once per call or setup
+#define REQUIRE_HOT 2    // Per access or step
+#ifndef REQUIRE_LEVEL
+#define REQUIRE_LEVEL REQUIRE_HOT
+#endif
+#define REQUIRE_AT(level, cond, msg) \
+  ((level) > REQUIRE_LEVEL || \
+    REQUIRE_LIKELY(cond) ? (void)0 : \
+    requireFailed(msg))
+
 inline void requireArgs(int argc, int args, 
   const std::string& msg = 
     "Must use %d arguments") {